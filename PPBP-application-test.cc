@@ -17,6 +17,16 @@
 /* This script configures two nodes connected vis CSMA channel. One of the
 *  nodes transmits packets via PPBP application to the other node.
 *  Command line parameters are the simulationTime and verbose for logging.
+*  With estimate=true the Hurst parameter and rate statistics of the sent
+*  traffic are estimated on the fly and printed at the end of the run.
+*  With tcp=true the PPBP source sends over TCP with Backpressure and stops
+*  one second (at most half the run) before the end of the simulation, while acks are still
+*  arriving; the bytes generated, in backlog and sent are printed at the end
+*  and the program fails unless generated = backlog + sent.
+*  packetSizes gives an empirical packet-size distribution, e.g. the IMIX
+*  --packetSizes=40:7,576:4,1500:1.
+*  rateProfile names a file of "time multiplier" lines that scales the
+*  burst arrival rate over time (piecewise linear).
 *  Example run: Copy to scratch folder and run
 *  ./waf --run "scratch/PPBP-application-test --simulationTime=10.0 --verbose=true"
 *  Author: Sharan Naribole <nsharan@rice.edu>
@@ -60,10 +70,18 @@ main (int argc, char *argv[])
 {
 
   double simulationTime = 5; //seconds
+  bool estimate = false;
+  bool tcp = false;
+  std::string packetSizes = "";
+  std::string rateProfile = "";
 
   CommandLine cmd;
   cmd.AddValue("simulationTime","Simulation time",simulationTime);
   cmd.AddValue("verbose","Output transmission and reception timestamps",verbose);
+  cmd.AddValue("estimate","Estimate H and the rate statistics of the sent traffic",estimate);
+  cmd.AddValue("tcp","Send over TCP, with backpressure",tcp);
+  cmd.AddValue("packetSizes","Packet sizes and weights, as size:weight,...",packetSizes);
+  cmd.AddValue("rateProfile","File of time multiplier lines for the burst arrival rate",rateProfile);
   cmd.Parse (argc, argv);
 
   Time::SetResolution (Time::NS);
@@ -89,23 +107,59 @@ main (int argc, char *argv[])
 
   uint32_t socketPort = 9;
 
-  PPBPHelper ppbp = PPBPHelper ("ns3::UdpSocketFactory",
+  PPBPHelper ppbp = PPBPHelper (tcp ? "ns3::TcpSocketFactory" : "ns3::UdpSocketFactory",
                        InetSocketAddress (interfaces.GetAddress (1),socketPort));
+  ppbp.SetAttribute ("Backpressure", BooleanValue (tcp));
+  ppbp.SetAttribute ("PacketSizeDistribution", StringValue (packetSizes));
+  if (!rateProfile.empty ())
+    {
+      Ptr<PPBPPiecewiseLinearRateProfile> profile = CreateObject<PPBPPiecewiseLinearRateProfile> ();
+      profile->SetAttribute ("File", StringValue (rateProfile));
+      ppbp.SetAttribute ("RateProfile", PointerValue (profile));
+    }
   ApplicationContainer apps = ppbp.Install (nodes.Get (0));
+  ppbp.AssignStreams (nodes, 0);
   apps.Start (Seconds (0));
-  apps.Stop (Seconds (simulationTime));
+  apps.Stop (Seconds (tcp ? std::max (simulationTime / 2, simulationTime - 1) : simulationTime));
 
-  Ptr<Socket> recvSink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
   InetSocketAddress local = InetSocketAddress (interfaces.GetAddress (1), socketPort);
-  recvSink->Bind (local);
-  recvSink->SetRecvCallback (MakeCallback (&ReceivePacket));
+  if (tcp)
+    {
+      PacketSinkHelper sink ("ns3::TcpSocketFactory", local);
+      sink.Install (nodes.Get (1));
+    }
+  else
+    {
+      Ptr<Socket> recvSink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+      recvSink->Bind (local);
+      recvSink->SetRecvCallback (MakeCallback (&ReceivePacket));
+    }
 
   Simulator::Stop (Seconds (simulationTime));
 
   Config::Connect("/NodeList/*/ApplicationList/*/Tx", MakeCallback (&TxTrace));
 
+  Ptr<PPBPHurstEstimator> estimator = CreateObject<PPBPHurstEstimator> ();
+  if (estimate)
+    {
+      apps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&PPBPHurstEstimator::NotifyTx, estimator));
+    }
 
   Simulator::Run ();
+  if (estimate)
+    {
+      estimator->Advance (Simulator::Now ());
+      estimator->Print (std::cout);
+    }
+  Ptr<PPBPApplication> app = DynamicCast<PPBPApplication> (apps.Get (0));
+  NS_LOG_UNCOND ("Generated " << app->GetGeneratedBytes () << " bytes, backlog "
+                 << app->GetBacklogBytes () << " bytes, sent " << app->GetTotalBytes () << " bytes");
+  bool balanced = app->GetGeneratedBytes () == app->GetBacklogBytes () + app->GetTotalBytes ();
   Simulator::Destroy ();
+  if (!balanced)
+    {
+      NS_LOG_UNCOND ("Generated bytes differ from backlog + sent");
+      return 1;
+    }
   return 0;
 }
@@ -35,6 +35,14 @@
 #include "ns3/double.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/nstime.h"
+#include "ns3/abort.h"
+#include "ns3/inet-socket-address.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 NS_LOG_COMPONENT_DEFINE ("PPBPApplication");
 
@@ -52,24 +60,124 @@ namespace ns3 {
 		.AddConstructor<PPBPApplication> ()
 		.AddAttribute ("BurstIntensity", "The data rate of each burst.",
 					   DataRateValue (DataRate ("1Mb/s")),
-					   MakeDataRateAccessor (&PPBPApplication::m_cbrRate),
+					   MakeDataRateAccessor (&PPBPApplication::SetBurstIntensity,
+											 &PPBPApplication::GetBurstIntensity),
 					   MakeDataRateChecker ())
 		.AddAttribute ("PacketSize", "The size of packets sent in on state",
 					   UintegerValue (1470),
-					   MakeUintegerAccessor (&PPBPApplication::m_pktSize),
+					   MakeUintegerAccessor (&PPBPApplication::SetPacketSize,
+											 &PPBPApplication::GetPacketSize),
 					   MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("PacketSizeDistribution", "Empirical packet sizes as \"size:weight,...\" "
+					   "(e.g. \"40:7,576:4,1500:1\"), used instead of PacketSize; empty for none.",
+					   StringValue (""),
+					   MakeStringAccessor (&PPBPApplication::SetPacketSizeDistribution,
+										   &PPBPApplication::GetPacketSizeDistribution),
+					   MakeStringChecker ())
+		.AddAttribute ("PacketSizeFile", "File of \"size weight\" lines giving empirical packet "
+					   "sizes, used instead of PacketSize; empty for none.",
+					   StringValue (""),
+					   MakeStringAccessor (&PPBPApplication::SetPacketSizeFile,
+										   &PPBPApplication::GetPacketSizeFile),
+					   MakeStringChecker ())
+		.AddAttribute ("HeaderOverhead", "Bytes of lower-layer headers added to each packet "
+					   "when pacing the bursts.",
+					   UintegerValue (30),
+					   MakeUintegerAccessor (&PPBPApplication::SetHeaderOverhead,
+											 &PPBPApplication::GetHeaderOverhead),
+					   MakeUintegerChecker<uint32_t> ())
+		.AddAttribute ("EnableSeqTsHeader", "Prepend a SeqTsHeader (sequence number and "
+					   "timestamp) to each packet, within PacketSize, which must then hold it.",
+					   BooleanValue (false),
+					   MakeBooleanAccessor (&PPBPApplication::SetSeqTsHeader,
+											&PPBPApplication::GetSeqTsHeader),
+					   MakeBooleanChecker ())
+		.AddAttribute ("TrainMode", "Send several back-to-back packets per transmit event.",
+					   BooleanValue (false),
+					   MakeBooleanAccessor (&PPBPApplication::m_trainMode),
+					   MakeBooleanChecker ())
+		.AddAttribute ("MaxTrainJitter", "Maximum timing error of a packet within a train.",
+					   TimeValue (MilliSeconds (1)),
+					   MakeTimeAccessor (&PPBPApplication::m_maxTrainJitter),
+					   MakeTimeChecker ())
+		.AddAttribute ("MaxTrainLength", "Maximum number of packets in a train.",
+					   UintegerValue (64),
+					   MakeUintegerAccessor (&PPBPApplication::m_maxTrainLength),
+					   MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("FluidMode", "Only produce the rate process (Rate trace); send no packets.",
+					   BooleanValue (false),
+					   MakeBooleanAccessor (&PPBPApplication::m_fluidMode),
+					   MakeBooleanChecker ())
+		.AddAttribute ("FgnSlot", "Slot of the fractional Gaussian noise approximation, 0 to "
+					   "simulate every burst. Each slot the number of active bursts is set to "
+					   "m + sqrt(m) fGn(H), m = MeanBurstArrivals x MeanBurstTimeLength.",
+					   TimeValue (Seconds (0)),
+					   MakeTimeAccessor (&PPBPApplication::m_fgnSlot),
+					   MakeTimeChecker ())
+		.AddAttribute ("FgnBlockSize", "Slots of each fGn path generated at once (rounded up "
+					   "to a power of two); the correlations are exact within a path.",
+					   UintegerValue (4096),
+					   MakeUintegerAccessor (&PPBPApplication::m_fgnBlockSize),
+					   MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("StationaryStart", "Start with the active bursts of the steady state "
+					   "instead of none.",
+					   BooleanValue (false),
+					   MakeBooleanAccessor (&PPBPApplication::m_stationaryStart),
+					   MakeBooleanChecker ())
+		.AddAttribute ("FlowPerBurst", "Send each burst on a socket of its own, from a pool, "
+					   "so that every burst is a distinct flow.",
+					   BooleanValue (false),
+					   MakeBooleanAccessor (&PPBPApplication::m_flowPerBurst),
+					   MakeBooleanChecker ())
+		.AddAttribute ("SocketPoolSize", "Sockets created at start for FlowPerBurst; the pool "
+					   "grows when more bursts are active.",
+					   UintegerValue (64),
+					   MakeUintegerAccessor (&PPBPApplication::m_socketPoolSize),
+					   MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("Backpressure", "Wait for the socket to connect and only send what its "
+					   "buffer accepts, keeping the rest in a backlog per burst (for TCP).",
+					   BooleanValue (false),
+					   MakeBooleanAccessor (&PPBPApplication::m_backpressure),
+					   MakeBooleanChecker ())
+		.AddAttribute ("PcapngFile", "Write the packets as Ethernet/IPv4/UDP frames to this pcapng "
+					   "file instead of sending them on a socket; empty for none. Applications "
+					   "given the same file share it.",
+					   StringValue (""),
+					   MakeStringAccessor (&PPBPApplication::m_pcapngFile),
+					   MakeStringChecker ())
+		.AddAttribute ("PcapngSnapLength", "Bytes of each frame captured in PcapngFile.",
+					   UintegerValue (65535),
+					   MakeUintegerAccessor (&PPBPApplication::m_pcapngSnapLength),
+					   MakeUintegerChecker<uint32_t> (42))
 		.AddAttribute ("MeanBurstArrivals", "Mean Active Sources",
 					   StringValue ("ns3::ConstantRandomVariable[Constant=20.0]"),
                    	   MakePointerAccessor (&PPBPApplication::m_burstArrivals),
                        MakePointerChecker <RandomVariableStream>())
+		.AddAttribute ("RateProfile", "Time-varying multiplier of MeanBurstArrivals "
+					   "(a PPBPRateProfile, may be shared), or null for a constant rate.",
+					   PointerValue (),
+					   MakePointerAccessor (&PPBPApplication::m_rateProfile),
+					   MakePointerChecker<PPBPRateProfile> ())
 		.AddAttribute ("MeanBurstTimeLength", "Mean burst duration",
 					   StringValue ("ns3::ConstantRandomVariable[Constant=0.2]"),
                    	   MakePointerAccessor (&PPBPApplication::m_burstLength),
                        MakePointerChecker <RandomVariableStream>())
+		.AddAttribute ("MaxBurstLength", "Upper bound of the burst lengths, 0 for none. The "
+					   "Pareto scale is raised so that the mean burst length is kept.",
+					   TimeValue (Seconds (0)),
+					   MakeTimeAccessor (&PPBPApplication::m_maxBurstLength),
+					   MakeTimeChecker ())
 		.AddAttribute ("H", "Hurst parameter",
 					   DoubleValue (0.7),
-					   MakeDoubleAccessor (&PPBPApplication::m_h),
+					   MakeDoubleAccessor (&PPBPApplication::SetHurst,
+										   &PPBPApplication::GetHurst),
 					   MakeDoubleChecker<double> ())
+		.AddAttribute ("VariateBlockSize", "Number of inter-arrival and burst-length variates "
+					   "drawn per block (0 draws them one by one).",
+					   UintegerValue (0),
+					   MakeUintegerAccessor (&PPBPApplication::SetVariateBlockSize,
+											 &PPBPApplication::GetVariateBlockSize),
+					   MakeUintegerChecker<uint32_t> ())
 		.AddAttribute ("Remote", "The address of the destination",
 					   AddressValue (),
 					   MakeAddressAccessor (&PPBPApplication::m_peer),
@@ -81,19 +189,65 @@ namespace ns3 {
 		.AddTraceSource ("Tx", "A new packet is created and is sent",
 						 MakeTraceSourceAccessor (&PPBPApplication::m_txTrace),
 						 "ns3::Packet::TracedCallback")
+		.AddTraceSource ("Rate", "Instantaneous offered rate (bit/s) of the active bursts",
+						 MakeTraceSourceAccessor (&PPBPApplication::m_rate),
+						 "ns3::TracedValueCallback::Double")
+		.AddTraceSource ("ActiveBursts", "Number of active bursts",
+						 MakeTraceSourceAccessor (&PPBPApplication::m_activebursts),
+						 "ns3::TracedValueCallback::Uint32")
+		.AddTraceSource ("BurstStart", "A burst starts; carries its length",
+						 MakeTraceSourceAccessor (&PPBPApplication::m_burstStartTrace),
+						 "ns3::Time::TracedCallback")
+		.AddTraceSource ("BurstEnd", "A burst ends; carries its length",
+						 MakeTraceSourceAccessor (&PPBPApplication::m_burstEndTrace),
+						 "ns3::Time::TracedCallback")
 		;
 		return tid;
 	}
 
 	PPBPApplication::PPBPApplication ()
+		: m_engine (Arrivals (this), Lengths (this), Sizes (this), Sink (this))
 	{
 		NS_LOG_FUNCTION_NOARGS ();
 		m_socket = 0;
 		m_connected = false;
 		m_lastStartTime = Seconds (0);
 		m_totalBytes = 0;
+		m_totalPackets = 0;
+		m_totalBursts = 0;
+		m_totalEvents = 0;
 		m_activebursts = 0;
-		m_offPeriod = true;
+		m_boundedMean = 0;
+		m_boundedShape = 0;
+		m_boundedScale = 0;
+		m_configuredMean = 0;
+		m_burstLengthSum = 0;
+		m_burstArrivalsDraws = 0;
+		m_burstLengthDraws = 0;
+		m_arrivalDraws = 0;
+		m_lengthDraws = 0;
+		m_sizeDraws = 0;
+		m_fgnBlockSize = 4096;
+		m_fgnNext = 0;
+		m_fgnMean = 0;
+		m_rate = 0;
+		m_variateBlockSize = 0;
+		m_pktSize = 1470;
+		m_cbrRate = DataRate ("1Mb/s");
+		m_headerOverhead = 30;
+		m_seqTsHeader = false;
+		m_seq = 0;
+		m_flowPerBurst = false;
+		m_socketPoolSize = 64;
+		m_pcapngSnapLength = 65535;
+		m_pcapngSource = 0;
+		m_backpressure = false;
+		m_generatedBytes = 0;
+		m_backlogBytes = 0;
+		m_nextFlow = 0;
+		m_arrivalVariate = CreateObject<ExponentialRandomVariable> ();
+		m_lengthVariate = CreateObject<ParetoRandomVariable> ();
+		m_sizeVariate = CreateObject<UniformRandomVariable> ();
 	}
 
 	PPBPApplication::~PPBPApplication()
@@ -101,18 +255,511 @@ namespace ns3 {
 		NS_LOG_FUNCTION_NOARGS ();
 	}
 
-	uint32_t
+	uint64_t
 	PPBPApplication::GetTotalBytes() const
 	{
 		return m_totalBytes;
 	}
 
+	uint64_t
+	PPBPApplication::GetGeneratedBytes() const
+	{
+		return m_generatedBytes;
+	}
+
+	uint64_t
+	PPBPApplication::GetBacklogBytes() const
+	{
+		return m_backlogBytes;
+	}
+
+	uint64_t
+	PPBPApplication::GetTotalPackets() const
+	{
+		return m_totalPackets;
+	}
+
+	uint64_t
+	PPBPApplication::GetTotalBursts() const
+	{
+		return m_totalBursts;
+	}
+
+	uint64_t
+	PPBPApplication::GetTotalEvents() const
+	{
+		return m_totalEvents;
+	}
+
+	uint32_t
+	PPBPApplication::GetActiveBursts() const
+	{
+		return m_activebursts;
+	}
+
+	Time
+	PPBPApplication::GetConfiguredMeanBurstLength() const
+	{
+		return Seconds (m_configuredMean);
+	}
+
+	Time
+	PPBPApplication::GetEffectiveMeanBurstLength() const
+	{
+		return Seconds (m_totalBursts ? m_burstLengthSum / m_totalBursts : 0);
+	}
+
+	int64_t
+	PPBPApplication::AssignStreams (int64_t stream)
+	{
+		NS_LOG_FUNCTION (this << stream);
+		m_burstArrivals->SetStream (stream);
+		m_burstLength->SetStream (stream + 1);
+		m_arrivalVariate->SetStream (stream + 2);
+		m_lengthVariate->SetStream (stream + 3);
+		// Only one of the two paths draws, so they share the streams
+		m_variates.AssignStreams (stream + 2);
+		m_sizeVariate->SetStream (stream + 4);
+		return 5;
+	}
+
+	namespace {
+
+		// Checkpoint layout: magic, version, then little-endian 64-bit fields
+		const char PPBP_CHECKPOINT_MAGIC[8] = { 'P', 'P', 'B', 'P', 'C', 'K', 'P', '\0' };
+		const uint64_t PPBP_CHECKPOINT_VERSION = 3;
+
+		// m_flowPosition of a flow without an active burst
+		const uint32_t PPBP_NO_POSITION = 0xffffffff;
+
+		void
+		Put (std::vector<uint8_t> &b, uint64_t v)
+		{
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				b.push_back ((v >> (8 * i)) & 0xff);
+			}
+		}
+
+		void
+		PutDouble (std::vector<uint8_t> &b, double d)
+		{
+			uint64_t v;
+			std::memcpy (&v, &d, sizeof (v));
+			Put (b, v);
+		}
+
+		class CheckpointReader
+		{
+		public:
+			CheckpointReader (const std::vector<uint8_t> &b) : m_b (b), m_pos (0) {}
+
+			uint64_t Get ()
+			{
+				NS_ABORT_MSG_IF (m_pos + 8 > m_b.size (), "Truncated PPBP checkpoint");
+				uint64_t v = 0;
+				for (uint32_t i = 0; i < 8; ++i)
+				{
+					v |= (uint64_t) m_b[m_pos++] << (8 * i);
+				}
+				return v;
+			}
+
+			double GetDouble ()
+			{
+				uint64_t v = Get ();
+				double d;
+				std::memcpy (&d, &v, sizeof (d));
+				return d;
+			}
+
+		private:
+			const std::vector<uint8_t> &m_b;
+			size_t m_pos;
+		};
+
+	} // anonymous namespace
+
+	std::vector<uint8_t>
+	PPBPApplication::Checkpoint () const
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		NS_ABORT_MSG_IF (m_arrivalVariate->GetStream () < 0 || m_lengthVariate->GetStream () < 0
+						 || m_sizeVariate->GetStream () < 0,
+						 "PPBPApplication::Checkpoint needs the streams fixed with AssignStreams");
+		NS_ABORT_MSG_IF (m_backpressure, "PPBPApplication::Checkpoint does not support Backpressure");
+		NS_ABORT_MSG_IF (m_fgnSlot.IsStrictlyPositive (), "PPBPApplication::Checkpoint does not support FgnSlot");
+
+		std::vector<uint8_t> b;
+		b.insert (b.end (), PPBP_CHECKPOINT_MAGIC, PPBP_CHECKPOINT_MAGIC + 8);
+		Put (b, PPBP_CHECKPOINT_VERSION);
+		Put (b, Seconds (1).GetTimeStep ());
+		Put (b, Simulator::Now ().GetTimeStep ());
+
+		// Burst process
+		Put (b, m_engine.GetNextArrival ());
+		Put (b, m_engine.GetNextLength ());
+		Engine::Departures departures = m_engine.GetDepartures ();
+		Put (b, departures.size ());
+		while (!departures.empty ())
+		{
+			Put (b, departures.top ().end);
+			Put (b, departures.top ().length);
+			Put (b, departures.top ().tag);
+			departures.pop ();
+		}
+		PutDouble (b, m_configuredMean);
+		PutDouble (b, m_timeSlot);
+
+		// Packets
+		Put (b, m_engine.IsOffPeriod ());
+		Put (b, m_engine.GetNextTx ());
+		Put (b, m_engine.GetTrainLength ());
+		Put (b, m_engine.GetPacer ().GetLast ());
+		Put (b, m_engine.GetPacer ().GetActive ());
+		Put (b, m_engine.GetPacer ().GetCredit ());
+		Put (b, m_seq);
+
+		// Counters
+		Put (b, m_totalBytes);
+		Put (b, m_totalPackets);
+		Put (b, m_totalBursts);
+		Put (b, m_totalEvents);
+		PutDouble (b, m_burstLengthSum);
+
+		// Stream positions
+		Put (b, m_burstArrivalsDraws);
+		Put (b, m_burstLengthDraws);
+		Put (b, m_arrivalDraws);
+		Put (b, m_lengthDraws);
+		uint64_t expDrawn, paretoDrawn;
+		uint32_t expNext, paretoNext;
+		m_variates.GetState (expDrawn, expNext, paretoDrawn, paretoNext);
+		Put (b, m_variateBlockSize);
+		Put (b, expDrawn);
+		Put (b, expNext);
+		Put (b, paretoDrawn);
+		Put (b, paretoNext);
+
+		// Flows (version 2)
+		Put (b, m_pool.size ());
+		for (uint32_t i = 0; i < m_flowRemote.size (); ++i)
+		{
+			Put (b, m_flowRemote[i]);
+		}
+		Put (b, m_freeFlows.size ());
+		for (uint32_t i = 0; i < m_freeFlows.size (); ++i)
+		{
+			Put (b, m_freeFlows[i]);
+		}
+		Put (b, m_activeFlows.size ());
+		for (uint32_t i = 0; i < m_activeFlows.size (); ++i)
+		{
+			Put (b, m_activeFlows[i]);
+		}
+		Put (b, m_nextFlow);
+
+		// Packet sizes (version 3)
+		Put (b, m_sizeDraws);
+		const std::vector<uint32_t> &trainSizes = m_engine.GetTrainSizes ();
+		Put (b, trainSizes.size ());
+		for (uint32_t i = 0; i < trainSizes.size (); ++i)
+		{
+			Put (b, trainSizes[i]);
+		}
+		return b;
+	}
+
+	void
+	PPBPApplication::Restore (const std::vector<uint8_t> &state)
+	{
+		NS_LOG_FUNCTION (this << state.size ());
+		NS_ABORT_MSG_IF (state.size () < 8 || std::memcmp (&state[0], PPBP_CHECKPOINT_MAGIC, 8) != 0,
+						 "Not a PPBP checkpoint");
+		m_restoreState = state;
+	}
+
+	void
+	PPBPApplication::RestoreState()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		NS_ABORT_MSG_IF (m_burstArrivalsDraws || m_burstLengthDraws || m_arrivalDraws || m_lengthDraws || m_sizeDraws,
+						 "PPBPApplication::Restore needs streams that have not been drawn from");
+		CheckpointReader r (m_restoreState);
+		r.Get ();							// Magic, checked by Restore
+		uint64_t version = r.Get ();
+		NS_ABORT_MSG_IF (version < 1 || version > PPBP_CHECKPOINT_VERSION, "Unsupported PPBP checkpoint version");
+		NS_ABORT_MSG_IF ((int64_t) r.Get () != Seconds (1).GetTimeStep (), "PPBP checkpoint saved with another time resolution");
+		int64_t shift = Simulator::Now ().GetTimeStep () - (int64_t) r.Get ();
+
+		int64_t arrival = r.Get () + shift;
+		int64_t arrivalLength = r.Get ();
+		m_engine.SetNextArrival (arrival, arrivalLength);
+		uint64_t n = r.Get ();
+		for (uint64_t i = 0; i < n; ++i)
+		{
+			int64_t end = r.Get () + shift;
+			int64_t length = r.Get ();
+			m_engine.AddBurst (end, length, version >= 2 ? r.Get () : 0);
+		}
+		m_activebursts = n;
+		m_configuredMean = r.GetDouble ();
+		m_timeSlot = r.GetDouble ();
+		UpdateRate ();
+
+		bool offPeriod = r.Get ();
+		int64_t nextTx = r.Get () + shift;
+		uint32_t trainLength = r.Get ();
+		m_engine.SetTx (offPeriod, nextTx, trainLength);
+		int64_t last = r.Get () + shift;
+		uint32_t active = r.Get ();
+		m_engine.GetPacer ().Restore (last, active, r.Get ());
+		m_seq = r.Get ();
+
+		m_totalBytes = r.Get ();
+		m_generatedBytes = m_totalBytes;	// No backlog without Backpressure
+		m_totalPackets = r.Get ();
+		m_totalBursts = r.Get ();
+		m_totalEvents = r.Get ();
+		m_burstLengthSum = r.GetDouble ();
+
+		// Draw again what the saved streams had drawn
+		m_burstArrivalsDraws = r.Get ();
+		for (uint64_t i = 0; i < m_burstArrivalsDraws; ++i)
+		{
+			m_burstArrivals->GetValue ();
+		}
+		m_burstLengthDraws = r.Get ();
+		for (uint64_t i = 0; i < m_burstLengthDraws; ++i)
+		{
+			m_burstLength->GetValue ();
+		}
+		m_arrivalDraws = r.Get ();
+		for (uint64_t i = 0; i < m_arrivalDraws; ++i)
+		{
+			m_arrivalVariate->GetValue (1, 0);
+		}
+		m_lengthDraws = r.Get ();
+		for (uint64_t i = 0; i < m_lengthDraws; ++i)
+		{
+			m_lengthVariate->GetValue (1, m_shape, 0);
+		}
+		NS_ABORT_MSG_IF (r.Get () != m_variateBlockSize, "PPBP checkpoint saved with another VariateBlockSize");
+		uint64_t expDrawn = r.Get ();
+		uint32_t expNext = r.Get ();
+		uint64_t paretoDrawn = r.Get ();
+		uint32_t paretoNext = r.Get ();
+		m_variates.SetState (expDrawn, expNext, paretoDrawn, paretoNext);
+
+		NS_ABORT_MSG_IF (version < 2 && !m_pool.empty (), "PPBP checkpoint saved without FlowPerBurst");
+		if (version >= 2)
+		{
+			uint32_t size = r.Get ();
+			NS_ABORT_MSG_IF (size > 0 && m_pool.empty (), "PPBP checkpoint saved with FlowPerBurst");
+			NS_ABORT_MSG_IF (size == 0 && !m_pool.empty (), "PPBP checkpoint saved without FlowPerBurst");
+			while (m_pool.size () < size)
+			{
+				m_pool.push_back (CreatePoolSocket ());
+			}
+			m_flowRemote.assign (m_pool.size (), 0);
+			m_flowPosition.assign (m_pool.size (), PPBP_NO_POSITION);
+			m_flowBacklog.assign (m_pool.size (), 0);
+			for (uint32_t i = 0; i < size; ++i)
+			{
+				m_flowRemote[i] = r.Get ();
+			}
+			m_freeFlows.resize (r.Get ());
+			for (uint32_t i = 0; i < m_freeFlows.size (); ++i)
+			{
+				m_freeFlows[i] = r.Get ();
+			}
+			m_activeFlows.resize (r.Get ());
+			for (uint32_t i = 0; i < m_activeFlows.size (); ++i)
+			{
+				m_activeFlows[i] = r.Get ();
+				m_flowPosition[m_activeFlows[i]] = i;
+				ConnectFlow (m_activeFlows[i]);
+			}
+			m_nextFlow = r.Get ();
+		}
+
+		if (version >= 3)
+		{
+			m_sizeDraws = r.Get ();
+			for (uint64_t i = 0; i < m_sizeDraws; ++i)
+			{
+				m_sizeVariate->GetValue ();
+			}
+			std::vector<uint32_t> &trainSizes = m_engine.GetTrainSizes ();
+			trainSizes.resize (r.Get ());
+			for (uint32_t i = 0; i < trainSizes.size (); ++i)
+			{
+				trainSizes[i] = r.Get ();
+			}
+		}
+
+		m_restoreState.clear ();
+	}
+
+	void
+	PPBPApplication::SetHurst (double h)
+	{
+		NS_LOG_FUNCTION (this << h);
+		m_h = h;
+		m_shape = 3 - 2 * m_h;
+		m_variates.SetShape (m_shape);
+	}
+
+	double
+	PPBPApplication::GetHurst () const
+	{
+		return m_h;
+	}
+
+	void
+	PPBPApplication::SetPacketSize (uint32_t size)
+	{
+		NS_LOG_FUNCTION (this << size);
+		m_pktSize = size;
+		m_packetTemplates.clear ();
+		UpdatePacer ();
+	}
+
+	uint32_t
+	PPBPApplication::GetPacketSize () const
+	{
+		return m_pktSize;
+	}
+
+	void
+	PPBPApplication::SetPacketSizeDistribution (std::string spec)
+	{
+		NS_LOG_FUNCTION (this << spec);
+		m_sizeSpec = spec;
+		if (m_sizeFile.empty ())				// Else the file is used
+		{
+			m_sizes.Parse (spec);
+		}
+		m_packetTemplates.clear ();
+		UpdatePacer ();
+	}
+
+	std::string
+	PPBPApplication::GetPacketSizeDistribution () const
+	{
+		return m_sizeSpec;
+	}
+
+	void
+	PPBPApplication::SetPacketSizeFile (std::string fileName)
+	{
+		NS_LOG_FUNCTION (this << fileName);
+		m_sizeFile = fileName;
+		if (fileName.empty ())
+		{
+			m_sizes.Parse (m_sizeSpec);
+		}
+		else
+		{
+			m_sizes.Load (fileName);
+		}
+		m_packetTemplates.clear ();
+		UpdatePacer ();
+	}
+
+	std::string
+	PPBPApplication::GetPacketSizeFile () const
+	{
+		return m_sizeFile;
+	}
+
+	uint32_t
+	PPBPApplication::GetSize (uint32_t sizeClass) const
+	{
+		return m_sizes.IsEmpty () ? m_pktSize : m_sizes.GetSize (sizeClass);
+	}
+
+	void
+	PPBPApplication::SetBurstIntensity (DataRate rate)
+	{
+		NS_LOG_FUNCTION (this << rate);
+		m_cbrRate = rate;
+		UpdatePacer ();
+	}
+
+	DataRate
+	PPBPApplication::GetBurstIntensity () const
+	{
+		return m_cbrRate;
+	}
+
+	void
+	PPBPApplication::SetHeaderOverhead (uint32_t overhead)
+	{
+		NS_LOG_FUNCTION (this << overhead);
+		m_headerOverhead = overhead;
+		UpdatePacer ();
+	}
+
+	uint32_t
+	PPBPApplication::GetHeaderOverhead () const
+	{
+		return m_headerOverhead;
+	}
+
+	void
+	PPBPApplication::UpdatePacer ()
+	{
+		// With a size distribution only train lengths use the mean size
+		double size = m_sizes.IsEmpty () ? m_pktSize : m_sizes.GetMean ();
+		uint32_t bits = (uint32_t) std::floor ((size + m_headerOverhead) * 8 + 0.5);
+		m_engine.GetPacer ().SetPacketBits (bits, Seconds (1).GetTimeStep ());
+		m_engine.GetPacer ().SetBurstRate (m_cbrRate.GetBitRate ());
+	}
+
+	void
+	PPBPApplication::SetVariateBlockSize (uint32_t size)
+	{
+		NS_LOG_FUNCTION (this << size);
+		m_variateBlockSize = size;
+		if (size != 0)
+		{
+			m_variates.SetBlockSize (size);
+		}
+	}
+
+	uint32_t
+	PPBPApplication::GetVariateBlockSize () const
+	{
+		return m_variateBlockSize;
+	}
+
+	void
+	PPBPApplication::SetSeqTsHeader (bool enable)
+	{
+		NS_LOG_FUNCTION (this << enable);
+		m_seqTsHeader = enable;
+		m_packetTemplates.clear ();
+	}
+
+	bool
+	PPBPApplication::GetSeqTsHeader () const
+	{
+		return m_seqTsHeader;
+	}
+
 	void
 	PPBPApplication::DoDispose (void)
 	{
 		NS_LOG_FUNCTION_NOARGS ();
 
 		m_socket = 0;
+		m_pool.clear ();
+		m_packetTemplates.clear ();
+		m_pcapng = 0;
+		m_arrivalVariate = 0;
+		m_lengthVariate = 0;
+		m_sizeVariate = 0;
 		// chain up
 		Application::DoDispose ();
 	}
@@ -122,9 +769,50 @@ namespace ns3 {
 	PPBPApplication::StartApplication() // Called at time specified by Start
 	{
 		NS_LOG_FUNCTION_NOARGS ();
+		NS_ABORT_MSG_IF (m_fgnSlot.IsStrictlyPositive () && (m_flowPerBurst || m_backpressure),
+						 "FgnSlot has no bursts for FlowPerBurst or Backpressure");
 
-		// Create the socket if not already
-		if (!m_socket)
+		// Create the socket if not already (the fluid mode sends nothing)
+		if (!m_pcapngFile.empty () && !m_fluidMode)
+		{
+			NS_ABORT_MSG_IF (m_backpressure, "Backpressure needs a socket, not a PcapngFile");
+			if (!m_pcapng)
+			{
+				// Frames go to the address of Remote, if it has one
+				uint32_t ip = 0x0afffffe;
+				uint16_t port = 9;
+				if (InetSocketAddress::IsMatchingType (m_peer))
+				{
+					InetSocketAddress peer = InetSocketAddress::ConvertFrom (m_peer);
+					ip = peer.GetIpv4 ().Get ();
+					port = peer.GetPort ();
+				}
+				m_pcapng = PPBPPcapngWriter::Get (m_pcapngFile, m_pcapngSnapLength);
+				m_pcapngSource = m_pcapng->AddSource (ip, port);
+			}
+		}
+		else if (m_backpressure && !m_fluidMode)
+		{
+			NS_ABORT_MSG_IF (m_flowPerBurst, "Backpressure does not support FlowPerBurst");
+			if (!m_socket)
+			{
+				m_connected = false;
+				m_socket = Socket::CreateSocket (GetNode(), m_protocolTid);
+				m_socket->SetConnectCallback (MakeCallback (&PPBPApplication::ConnectionSucceeded, this),
+											  MakeCallback (&PPBPApplication::ConnectionFailed, this));
+				m_socket->SetSendCallback (MakeCallback (&PPBPApplication::DataSend, this));
+				m_socket->Bind ();
+				m_socket->Connect (m_peer);
+			}
+		}
+		else if (m_flowPerBurst && !m_fluidMode)
+		{
+			while (m_pool.size () < m_socketPoolSize)
+			{
+				m_pool.push_back (CreatePoolSocket ());
+			}
+		}
+		else if (!m_socket && !m_fluidMode)
 		{
 			m_socket = Socket::CreateSocket (GetNode(), m_protocolTid);
 			m_socket->Bind ();
@@ -132,49 +820,274 @@ namespace ns3 {
 		}
 		// Insure no pending event
 		CancelEvents ();
-		ScheduleStartEvent();
+		if (!m_backpressure || m_fluidMode || m_connected)
+		{
+			ScheduleStartEvent();
+		}
+		// else ConnectionSucceeded starts sending
 	}
 
-	void
-	PPBPApplication::PPBP() // Poisson Pareto Burst
+	Time
+	PPBPApplication::DrawArrival() // Poisson
 	{
 		NS_LOG_FUNCTION_NOARGS ();
 
 		double inter_burst_intervals;
 		inter_burst_intervals = (double) 1/m_burstArrivals->GetValue ();
+		++m_burstArrivalsDraws;
 
-		Ptr<ExponentialRandomVariable> exp = CreateObject<ExponentialRandomVariable> ();
-    	exp->SetAttribute ("Mean", DoubleValue (inter_burst_intervals));
+		if (m_rateProfile)
+		{
+			return DrawProfileArrival (1 / inter_burst_intervals);
+		}
+		return Simulator::Now () + Seconds (DrawExponential (inter_burst_intervals));
+	}
 
-		Time t_poisson_arrival = Seconds (exp->GetValue());
-		m_PoissonArrival = Simulator::Schedule(t_poisson_arrival,&PPBPApplication::PoissonArrival, this);
+	Time
+	PPBPApplication::DrawBurstLength() // Pareto
+	{
+		NS_LOG_FUNCTION_NOARGS ();
 
-		// Pareto
-		m_shape = 3 - 2 * m_h;
-		m_timeSlot = (double) (m_shape - 1) * m_burstLength->GetValue () / m_shape;
+		// m_shape follows the H attribute
+		m_configuredMean = m_burstLength->GetValue ();
+		++m_burstLengthDraws;
+		double bound = m_maxBurstLength.GetSeconds ();
+		if (bound > 0)
+		{
+			// Bounded Pareto with the scale that keeps the configured mean
+			if (m_configuredMean != m_boundedMean || m_shape != m_boundedShape)
+			{
+				NS_ABORT_MSG_IF (m_configuredMean >= bound, "MaxBurstLength must exceed the mean burst length");
+				m_boundedMean = m_configuredMean;
+				m_boundedShape = m_shape;
+				m_boundedScale = PPBPVariateBuffer::GetBoundedParetoScale (m_configuredMean, m_shape, bound);
+				NS_LOG_INFO ("Bursts bounded to " << bound << " s: scale " << m_boundedScale
+							 << " s keeps the mean at " << m_configuredMean << " s, plain truncation would give "
+							 << PPBPVariateBuffer::GetBoundedParetoMean ((m_shape - 1) * m_configuredMean / m_shape, m_shape, bound)
+							 << " s");
+			}
+			m_timeSlot = m_boundedScale;
+		}
+		else
+		{
+			m_timeSlot = (double) (m_shape - 1) * m_configuredMean / m_shape;
+		}
 
-		Ptr<ParetoRandomVariable> pareto = CreateObject<ParetoRandomVariable> ();
-		pareto->SetAttribute ("Scale", DoubleValue (m_timeSlot));
-		pareto->SetAttribute ("Shape", DoubleValue (m_shape));
+		// The burst is only recorded by m_engine; its departure enters the
+		// active bursts when it actually arrives.
+		return Seconds (DrawPareto (m_timeSlot, bound));
+	}
 
-    	double t_pareto = pareto->GetValue ();
+	uint32_t
+	PPBPApplication::DrawSizeClass()
+	{
+		++m_sizeDraws;
+		return m_sizes.Sample (m_sizeVariate->GetValue ());
+	}
 
-		m_ParetoDeparture = Simulator::Schedule(t_poisson_arrival + Seconds (t_pareto),&PPBPApplication::ParetoDeparture, this);
-		m_ppbp = Simulator::Schedule(t_poisson_arrival,&PPBPApplication::PPBP, this);
+	void
+	PPBPApplication::StationaryStart()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		// The bursts in progress at a random time of the stationary
+		// M/G/Infinity queue: a Poisson(lambda_p x Ton) number of them, each
+		// with a residual length from the equilibrium distribution. Uniforms
+		// are taken as exp(-E) so that no extra stream is needed.
+		double bound = m_maxBurstLength.GetSeconds ();
+		NS_ABORT_MSG_IF (m_shape <= 1 && bound <= 0, "StationaryStart needs H < 1 or a MaxBurstLength");
+		double mean = m_burstArrivals->GetValue () * m_configuredMean;
+		if (m_rateProfile)
+		{
+			// Exact while the profile is flat over the recent burst lengths
+			mean *= m_rateProfile->GetValue (Simulator::Now ().GetSeconds ());
+		}
+		++m_burstArrivalsDraws;
+		double sum = DrawExponential (1);
+		while (sum <= mean)
+		{
+			double u1 = std::exp (-DrawExponential (1));
+			double u2 = std::exp (-DrawExponential (1));
+			Time length = Seconds (PPBPVariateBuffer::GetResidualPareto (m_timeSlot, m_shape, bound, u1, u2));
+			uint32_t flow = TracksBursts () ? AcquireFlow () : 0;
+			m_engine.AddBurst ((Simulator::Now () + length).GetTimeStep (), length.GetTimeStep (), flow);
+			m_burstStartTrace (length);
+			sum += DrawExponential (1);
+		}
+		m_activebursts = m_engine.GetActive ();
+		NS_LOG_INFO ("Stationary start with " << m_activebursts << " active bursts");
+		UpdateRate ();
 	}
 
-	void PPBPApplication::PoissonArrival()
+	void
+	PPBPApplication::FgnSlot()
 	{
 		NS_LOG_FUNCTION_NOARGS ();
-		++m_activebursts;
-		if (m_offPeriod) ScheduleNextTx();
+		if (m_fgnNext >= m_fgnSamples.size ())
+		{
+			DrawFgnBlock ();
+		}
+		double mean = m_fgnMean;
+		if (m_rateProfile)
+		{
+			mean *= m_rateProfile->GetValue (Simulator::Now ().GetSeconds ());
+		}
+		// Poisson mean and variance, Gaussian at this scale
+		double n = mean + std::sqrt (mean) * m_fgnSamples[m_fgnNext++];
+		m_engine.SetActive (Simulator::Now ().GetTimeStep (), n > 0 ? (uint32_t) std::floor (n + 0.5) : 0);
+		m_activebursts = m_engine.GetActive ();
+		UpdateRate ();
+		m_nextSlot += m_fgnSlot;
 	}
 
 	void
-	PPBPApplication::ParetoDeparture()
+	PPBPApplication::DrawFgnBlock()
 	{
 		NS_LOG_FUNCTION_NOARGS ();
-		--m_activebursts;
+		uint32_t n = m_fgn.GetPathLength ();
+		if (n < m_fgnBlockSize || n >= 2 * m_fgnBlockSize || m_fgn.GetHurst () != m_h)
+		{
+			m_fgn.Set (m_h, m_fgnBlockSize);
+		}
+		m_fgnMean = m_burstArrivals->GetValue () * m_burstLength->GetValue ();
+		++m_burstArrivalsDraws;
+		++m_burstLengthDraws;
+
+		// Box-Muller on the arrival stream, which draws no arrival here:
+		// the radius is sqrt(2E) and the angle 2 pi exp(-E)
+		m_fgnNormals.resize (m_fgn.GetNormalsPerBlock ());
+		for (uint32_t i = 0; i < m_fgnNormals.size (); i += 2)
+		{
+			double radius = std::sqrt (2 * DrawExponential (1));
+			double angle = 2 * M_PI * std::exp (-DrawExponential (1));
+			m_fgnNormals[i] = radius * std::cos (angle);
+			m_fgnNormals[i + 1] = radius * std::sin (angle);
+		}
+		m_fgn.Generate (&m_fgnNormals[0], m_fgnSamples);
+		m_fgnNext = 0;
+	}
+
+	Time
+	PPBPApplication::DrawProfileArrival(double rate)
+	{
+		// Lewis-Shedler thinning, restarted at the end of every span of the
+		// profile bound; uniforms are taken as exp(-E)
+		if (rate <= 0)
+		{
+			return Time::Max ();
+		}
+		double t = Simulator::Now ().GetSeconds ();
+		while (true)
+		{
+			double until;
+			double bound = rate * m_rateProfile->GetBound (t, until);
+			if (bound <= 0)
+			{
+				if (std::isinf (until))
+				{
+					return Time::Max ();	// No burst arrives any more
+				}
+				t = until;
+				continue;
+			}
+			double next = t + DrawExponential (1 / bound);
+			if (next >= until)
+			{
+				t = until;
+				continue;
+			}
+			t = next;
+			if (std::exp (-DrawExponential (1)) * bound <= rate * m_rateProfile->GetValue (t))
+			{
+				return Seconds (t);
+			}
+		}
+	}
+
+	double
+	PPBPApplication::DrawExponential(double mean)
+	{
+		if (m_variateBlockSize)
+		{
+			return m_variates.GetExponential (mean);
+		}
+		++m_arrivalDraws;
+		return m_arrivalVariate->GetValue (mean, 0);
+	}
+
+	double
+	PPBPApplication::DrawPareto(double scale, double bound)
+	{
+		if (m_variateBlockSize)
+		{
+			return m_variates.GetPareto (scale, bound);
+		}
+		// The rejection of ParetoRandomVariable, made explicit so that every
+		// value drawn is counted
+		double v;
+		do
+		{
+			v = m_lengthVariate->GetValue (scale, m_shape, 0);
+			++m_lengthDraws;
+		}
+		while (bound > 0 && v > bound);
+		return v;
+	}
+
+	uint32_t PPBPApplication::PoissonArrival(Time length)
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		m_activebursts = m_engine.GetActive ();
+		++m_totalBursts;
+		m_burstLengthSum += length.GetSeconds ();
+		uint32_t flow = TracksBursts () ? AcquireFlow () : 0;
+		m_burstStartTrace (length);
+		UpdateRate ();
+		return flow;						// m_engine keeps it with the burst
+	}
+
+	void
+	PPBPApplication::ParetoDeparture(Time length, uint32_t flow)
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		if (TracksBursts ())
+		{
+			ReleaseFlow (flow);
+		}
+		m_activebursts = m_engine.GetActive ();
+		m_burstEndTrace (length);
+		UpdateRate ();
+	}
+
+	void
+	PPBPApplication::UpdateRate()
+	{
+		m_rate = (double) m_activebursts * m_cbrRate.GetBitRate ();
+	}
+
+	void
+	PPBPApplication::ProcessEvents()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		if (m_fgnSlot.IsStrictlyPositive () && m_nextSlot <= Simulator::Now ())
+		{
+			FgnSlot ();
+		}
+		m_engine.Process (Simulator::Now ().GetTimeStep ());
+		ScheduleTimer ();
+	}
+
+	void
+	PPBPApplication::ScheduleTimer()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		Time next = TimeStep (m_engine.GetNextEvent ());
+		if (m_fgnSlot.IsStrictlyPositive () && m_nextSlot < next)
+		{
+			next = m_nextSlot;
+		}
+		Simulator::Cancel (m_timer);
+		m_timer = Simulator::Schedule (next - Simulator::Now (), &PPBPApplication::ProcessEvents, this);
+		++m_totalEvents;
 	}
 
 	void
@@ -183,20 +1096,36 @@ namespace ns3 {
 		NS_LOG_FUNCTION_NOARGS ();
 
 		CancelEvents ();
-		if(m_socket != 0) m_socket->Close ();
-		else NS_LOG_WARN("PPBPApplication found null socket to close in StopApplication");
+		for (uint32_t i = 0; i < m_pool.size (); ++i)
+		{
+			m_pool[i]->Close ();
+		}
+		m_pool.clear ();
+		if(m_socket != 0 && m_backpressure)
+		{
+			// Later acks must not drain into a closed socket; the backlog is
+			// dropped but stays counted in GetBacklogBytes
+			m_socket->SetConnectCallback (MakeNullCallback<void, Ptr<Socket> > (),
+										  MakeNullCallback<void, Ptr<Socket> > ());
+			m_socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+			m_flowBacklog.assign (m_flowBacklog.size (), 0);
+			m_backloggedFlows.clear ();
+			// Connect again at the next start
+			m_socket->Close ();
+			m_socket = 0;
+			m_connected = false;
+		}
+		else if(m_socket != 0) m_socket->Close ();
+		else if(m_pcapng != 0) NS_ABORT_MSG_IF (!m_pcapng->Flush (), "Cannot write pcapng file " << m_pcapngFile);
+		else if (!m_fluidMode && !m_flowPerBurst) NS_LOG_WARN("PPBPApplication found null socket to close in StopApplication");
 	}
 
 	void
 	PPBPApplication::CancelEvents ()
 	{
 		NS_LOG_FUNCTION_NOARGS ();
-		Simulator::Cancel(m_sendEvent);
 		Simulator::Cancel(m_startStopEvent);
-
-		Simulator::Cancel(m_ppbp);
-		Simulator::Cancel(m_PoissonArrival);
-		Simulator::Cancel(m_ParetoDeparture);
+		Simulator::Cancel(m_timer);
 	}
 
 	// Event handlers
@@ -205,7 +1134,46 @@ namespace ns3 {
 	{
 		NS_LOG_FUNCTION_NOARGS ();
 		m_lastStartTime = Simulator::Now();
-		ScheduleNextTx();					// Schedule the send packet event
+
+		// Bursts still in flight from a previous run are dropped
+		int64_t now = Simulator::Now ().GetTimeStep ();
+		m_activebursts = 0;
+		ResetFlows();
+		UpdateRate();
+		UpdatePacer();						// The time resolution is final by now
+		m_engine.SetFluid (m_fluidMode);
+		m_engine.SetTrains (m_trainMode, m_maxTrainJitter.GetTimeStep (), m_maxTrainLength);
+		m_engine.Reset (now);
+
+		if (!m_restoreState.empty ())
+		{
+			RestoreState();					// Resume a checkpoint instead
+		}
+		else if (m_fgnSlot.IsStrictlyPositive ())
+		{
+			m_fgnSamples.clear ();			// A new block at every start
+			m_fgnNext = 0;
+			m_nextSlot = Simulator::Now ();
+			FgnSlot ();						// No burst arrival is drawn
+			// Paths are independent, so correlations beyond one path are lost
+			double path = m_fgnSlot.GetSeconds () * m_fgn.GetPathLength ();
+			double run = (m_stopTime - Simulator::Now ()).GetSeconds ();
+			if (m_stopTime.IsStrictlyPositive () && run > 4 * path)
+			{
+				NS_LOG_WARN ("PPBPApplication runs " << run << " s, much longer than an fGn path of "
+							 << path << " s; raise FgnBlockSize to keep the long-range dependence beyond it");
+			}
+		}
+		else
+		{
+			m_engine.DrawArrival (now);		// Draw the first burst arrival
+			if (m_stationaryStart)
+			{
+				StationaryStart();
+			}
+			m_engine.Update (now);			// Schedule the send packet event
+		}
+		ScheduleTimer();
 		ScheduleStopEvent();
 	}
 
@@ -219,50 +1187,255 @@ namespace ns3 {
 	}
 
 	void
-	PPBPApplication::ScheduleNextTx()
+	PPBPApplication::ScheduleStartEvent()
 	{
 		NS_LOG_FUNCTION_NOARGS ();
-		uint32_t bits = (m_pktSize + 30) * 8;
-		Time nextTime(Seconds (bits /
-							   static_cast<double>(m_cbrRate.GetBitRate())));
+		m_startStopEvent = Simulator::Schedule(Seconds(0.0), &PPBPApplication::StartSending, this);
+		++m_totalEvents;
+	}
 
-		if (m_activebursts != 0)
+	void
+	PPBPApplication::ScheduleStopEvent()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+	}
+
+	Ptr<Packet>
+	PPBPApplication::MakePacket(uint32_t sizeClass)
+	{
+		if (m_packetTemplates.empty ())
+		{
+			// Built once per size; every packet sent is a copy-on-write copy of one
+			uint32_t n = m_sizes.IsEmpty () ? 1 : m_sizes.GetN ();
+			for (uint32_t i = 0; i < n; ++i)
+			{
+				uint32_t payload = GetSize (i);
+				if (m_seqTsHeader)
+				{
+					SeqTsHeader seqTs;
+					NS_ABORT_MSG_IF (payload < seqTs.GetSerializedSize (), "Packets of " << payload
+									 << " bytes cannot hold the " << seqTs.GetSerializedSize ()
+									 << "-byte SeqTsHeader of EnableSeqTsHeader");
+					payload -= seqTs.GetSerializedSize ();
+				}
+				m_packetTemplates.push_back (Create<Packet> (payload));
+			}
+		}
+		Ptr<Packet> packet = m_packetTemplates[sizeClass]->Copy ();
+		if (m_seqTsHeader)
 		{
-			m_offPeriod = false;
-			double data_rate = (double) nextTime.GetSeconds() / m_activebursts;
-			m_sendEvent = Simulator::Schedule(Seconds(data_rate),&PPBPApplication::SendPacket, this);
+			SeqTsHeader seqTs;
+			seqTs.SetSeq (m_seq++);
+			packet->AddHeader (seqTs);
+		}
+		return packet;
+	}
+
+	void
+	PPBPApplication::SendPacket(const uint32_t *sizeClasses, uint32_t packets)
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		if (m_backpressure)
+		{
+			// Queue the train on the bursts, then send what the socket takes
+			for (uint32_t i = 0; i < packets; ++i)
+			{
+				uint32_t size = GetSize (sizeClasses[i]);
+				uint32_t flow = NextFlow ();
+				if (m_flowBacklog[flow] == 0)
+				{
+					m_backloggedFlows.push_back (flow);
+				}
+				m_flowBacklog[flow] += size;
+				m_backlogBytes += size;
+				m_generatedBytes += size;
+			}
+			Drain ();
 		}
 		else
 		{
-			m_offPeriod = true;
+			for (uint32_t i = 0; i < packets; ++i)
+			{
+				Ptr<Packet> packet = MakePacket (sizeClasses[i]);
+				m_txTrace (packet);
+				if (m_pcapng)
+				{
+					m_pcapng->Write (Simulator::Now ().GetNanoSeconds (), packet->GetSize (), m_pcapngSource);
+				}
+				else if (m_pool.empty ())
+				{
+					m_socket->Send (packet);
+				}
+				else
+				{
+					m_pool[NextFlow ()]->Send (packet);
+				}
+				m_totalBytes += packet->GetSize();
+				m_generatedBytes += packet->GetSize();
+			}
+			m_totalPackets += packets;
 		}
+		m_lastStartTime = Simulator::Now();
+	}
 
+	void
+	PPBPApplication::Drain()
+	{
+		// One packet per backlogged burst in turn, while the buffer has room;
+		// the backlog is sent in PacketSize pieces
+		if (!m_socket || !m_connected)
+		{
+			return;
+		}
+		while (!m_backloggedFlows.empty ())
+		{
+			uint32_t flow = m_backloggedFlows.front ();
+			uint32_t size = std::min<uint64_t> (m_pktSize, m_flowBacklog[flow]);
+			if (m_socket->GetTxAvailable () < size)
+			{
+				break;
+			}
+			Ptr<Packet> packet;
+			if (size == m_pktSize && m_sizes.IsEmpty ())
+			{
+				packet = MakePacket (0);
+			}
+			else
+			{
+				packet = Create<Packet> (size);
+			}
+			if (m_socket->Send (packet) < 0)
+			{
+				NS_LOG_WARN ("PPBPApplication send failed with " << m_backlogBytes << " bytes in backlog");
+				break;
+			}
+			m_txTrace (packet);
+			m_totalBytes += packet->GetSize ();
+			++m_totalPackets;
+			m_flowBacklog[flow] -= size;
+			m_backlogBytes -= size;
+			m_backloggedFlows.pop_front ();
+			if (m_flowBacklog[flow] > 0)
+			{
+				m_backloggedFlows.push_back (flow);
+			}
+			else if (m_flowPosition[flow] == PPBP_NO_POSITION)
+			{
+				m_freeFlows.push_back (flow);		// Its burst has ended
+			}
+		}
 	}
 
 	void
-	PPBPApplication::ScheduleStartEvent()
+	PPBPApplication::DataSend(Ptr<Socket>, uint32_t)
 	{
 		NS_LOG_FUNCTION_NOARGS ();
-		m_ppbp = Simulator::Schedule(Seconds(0.0), &PPBPApplication::PPBP, this);
-		m_startStopEvent = Simulator::Schedule(Seconds(0.0), &PPBPApplication::StartSending, this);
+		Drain ();
 	}
 
 	void
-	PPBPApplication::ScheduleStopEvent()
+	PPBPApplication::AddRemote(Address remote)
 	{
-		NS_LOG_FUNCTION_NOARGS ();
+		NS_LOG_FUNCTION (this << remote);
+		m_remotes.push_back (remote);
+	}
+
+	Ptr<Socket>
+	PPBPApplication::CreatePoolSocket()
+	{
+		// Every socket binds its own ephemeral port, which makes the flow
+		Ptr<Socket> socket = Socket::CreateSocket (GetNode(), m_protocolTid);
+		socket->Bind ();
+		socket->Connect (m_remotes.empty () ? m_peer : m_remotes[0]);
+		return socket;
+	}
+
+	bool
+	PPBPApplication::TracksBursts() const
+	{
+		return (m_flowPerBurst || m_backpressure) && !m_fluidMode;
 	}
 
 	void
-	PPBPApplication::SendPacket()
+	PPBPApplication::ResetFlows()
 	{
-		NS_LOG_FUNCTION_NOARGS ();
-		Ptr<Packet> packet = Create<Packet> (m_pktSize);
-		m_txTrace (packet);
-		m_socket->Send (packet);
-		m_totalBytes += packet->GetSize();
-		m_lastStartTime = Simulator::Now();
-		ScheduleNextTx();
+		uint32_t n = m_flowPerBurst ? m_pool.size () : m_flowPosition.size ();
+		m_flowRemote.assign (n, 0);
+		m_flowPosition.assign (n, PPBP_NO_POSITION);
+		m_flowBacklog.assign (n, 0);
+		m_backloggedFlows.clear ();
+		m_activeFlows.clear ();
+		m_freeFlows.clear ();
+		for (uint32_t i = n; i > 0; --i)
+		{
+			m_freeFlows.push_back (i - 1);		// Flow 0 is taken first
+		}
+		m_nextFlow = 0;
+	}
+
+	uint32_t
+	PPBPApplication::AcquireFlow()
+	{
+		if (m_freeFlows.empty ())
+		{
+			m_freeFlows.push_back (m_flowPosition.size ());
+			if (!m_pool.empty ())
+			{
+				NS_LOG_INFO ("Socket pool grows to " << m_pool.size () + 1);
+				m_pool.push_back (CreatePoolSocket ());
+			}
+			m_flowRemote.push_back (0);
+			m_flowPosition.push_back (PPBP_NO_POSITION);
+			m_flowBacklog.push_back (0);
+		}
+		uint32_t flow = m_freeFlows.back ();
+		m_freeFlows.pop_back ();
+		if (m_remotes.size () > 1 && !m_pool.empty ())
+		{
+			// Uniform destination, from the arrival stream as exp(-E)
+			uint32_t n = m_remotes.size ();
+			double u = std::exp (-DrawExponential (1));
+			m_flowRemote[flow] = std::min<uint32_t> (n - 1, u * n);
+			ConnectFlow (flow);
+		}
+		m_flowPosition[flow] = m_activeFlows.size ();
+		m_activeFlows.push_back (flow);
+		return flow;
+	}
+
+	void
+	PPBPApplication::ReleaseFlow(uint32_t flow)
+	{
+		uint32_t position = m_flowPosition[flow];
+		uint32_t last = m_activeFlows.back ();
+		m_activeFlows[position] = last;
+		m_flowPosition[last] = position;
+		m_activeFlows.pop_back ();
+		m_flowPosition[flow] = PPBP_NO_POSITION;
+		if (m_flowBacklog[flow] == 0)
+		{
+			m_freeFlows.push_back (flow);		// Else freed once drained
+		}
+	}
+
+	uint32_t
+	PPBPApplication::NextFlow()
+	{
+		// Round-robin over the flows of the active bursts
+		if (m_nextFlow >= m_activeFlows.size ())
+		{
+			m_nextFlow = 0;
+		}
+		return m_activeFlows[m_nextFlow++];
+	}
+
+	void
+	PPBPApplication::ConnectFlow(uint32_t flow)
+	{
+		if (m_remotes.size () > 1)
+		{
+			m_pool[flow]->Connect (m_remotes[m_flowRemote[flow]]);
+		}
 	}
 
 	void
@@ -29,7 +29,20 @@
 #include "ns3/ptr.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "PPBP-variate-buffer.h"
+#include "PPBP-pacer.h"
+#include "PPBP-engine.h"
+#include "PPBP-size-distribution.h"
+#include "PPBP-pcapng.h"
+#include "PPBP-rate-profile.h"
+#include "PPBP-fgn.h"
+#include <functional>
+#include <utility>
+#include <deque>
+#include <vector>
 
 namespace ns3 {
 
@@ -78,6 +91,66 @@ namespace ns3 {
 	 * straightforward to compute the overall rate of the PPBP, lambda:
 	 * lambda = Ton x lambda_p x r
 	 *
+	 * With MaxBurstLength set, burst lengths follow a bounded Pareto whose
+	 * scale is solved so that the mean stays at Ton; this bounds the horizon
+	 * of every burst, and so the number of active bursts, while the scaling
+	 * holds over time scales well below the bound.
+	 *
+	 * With StationaryStart the application starts in the steady state of the
+	 * M/G/Infinity queue instead of with no burst: a Poisson(lambda_p x Ton)
+	 * number of bursts are already active, each with a residual length drawn
+	 * from the equilibrium distribution of the burst lengths, so no warm-up
+	 * has to be discarded.
+	 *
+	 * With FlowPerBurst every burst is sent on a socket of its own, so each
+	 * burst is a distinct flow (source port and, with AddRemote, a destination
+	 * drawn uniformly from a set) for hash-based load balancers. The sockets
+	 * come from a pool created at start and are recycled when bursts end;
+	 * packets are spread round-robin over the active bursts.
+	 *
+	 * With Backpressure the application waits for the socket to connect and
+	 * only hands the socket what fits in its send buffer, as needed for
+	 * ns3::TcpSocketFactory. The packets the bursts generate beyond that are
+	 * counted in a backlog per burst, which the send callback drains
+	 * round-robin over the bursts as space frees up; a burst keeps its
+	 * backlog after it ends until it is sent. The Tx trace and the sent
+	 * counters then follow what reaches the socket, GetGeneratedBytes what
+	 * the bursts offered and GetBacklogBytes what is still waiting.
+	 *
+	 * PacketSizeDistribution (inline) or PacketSizeFile gives an empirical
+	 * distribution of the packet sizes instead of the fixed PacketSize. The
+	 * size of every packet is drawn from an alias table when its departure is
+	 * scheduled, and the pacer charges the size drawn, so the bursts keep
+	 * their BurstIntensity.
+	 *
+	 * With PcapngFile no socket is used: every packet is written at its
+	 * departure time as a synthetic Ethernet/IPv4/UDP frame to a pcapng
+	 * file (see PPBPPcapngWriter), to produce captures for replay tools
+	 * without a topology. Applications writing the same file share one
+	 * time-ordered capture, each with its own source address and port.
+	 *
+	 * With a RateProfile the bursts arrive at the time-varying rate
+	 * MeanBurstArrivals x m(t), drawn by thinning (see PPBPRateProfile).
+	 * One profile object can be shared by all applications.
+	 *
+	 * With FgnSlot set the bursts are not simulated at all. For lambda_p x Ton
+	 * in the thousands and more, the number of active bursts is close to a
+	 * Gaussian process with the LRD of H, so every slot of FgnSlot it is set
+	 * to m + sqrt(m) X, with m = lambda_p x Ton (times the RateProfile) the
+	 * mean and variance of the Poisson number of active bursts and X
+	 * fractional Gaussian noise of Hurst parameter H (see PPBPFgnGenerator).
+	 * The packets, or the rate in FluidMode, then follow n(t) x r as usual,
+	 * at a cost per slot that does not depend on the number of bursts.
+	 *
+	 * In FluidMode no packets are sent and no socket is created: the
+	 * application only follows the bursts and reports the piecewise-constant
+	 * rate n(t) x r through the "Rate" trace source.
+	 *
+	 * The process itself runs in a PPBPEngine, whose policies draw from the
+	 * random variables of the application and hand the bursts and packet
+	 * trains back to it; the application only adds the simulator event, the
+	 * sockets, the traces and the checkpoints.
+	 *
 	 * References:
 	 * - - - - - -
 	 * [1]	A new tool for generating realistic Internet traffic in NS-3,
@@ -102,7 +175,91 @@ namespace ns3 {
 		/**
 		 * \brief Return total bytes sent by this object.
 		 */
-		uint32_t      GetTotalBytes() const;
+		uint64_t      GetTotalBytes() const;
+
+		/**
+		 * \brief Return total bytes generated by the bursts; more than
+		 * GetTotalBytes by the backlog with Backpressure.
+		 */
+		uint64_t      GetGeneratedBytes() const;
+
+		/**
+		 * \brief Return the bytes generated but not accepted by the socket
+		 * (Backpressure), including the backlog dropped at a stop, so that
+		 * GetGeneratedBytes is GetBacklogBytes plus GetTotalBytes.
+		 */
+		uint64_t      GetBacklogBytes() const;
+
+		/**
+		 * \brief Return total packets sent by this object.
+		 */
+		uint64_t      GetTotalPackets() const;
+
+		/**
+		 * \brief Return the number of bursts started so far.
+		 */
+		uint64_t      GetTotalBursts() const;
+
+		/**
+		 * \brief Return the number of simulator events scheduled by this object.
+		 */
+		uint64_t      GetTotalEvents() const;
+
+		/**
+		 * \brief Return the number of bursts active now.
+		 */
+		uint32_t      GetActiveBursts() const;
+
+		/**
+		 * \brief Return the mean burst length last drawn from MeanBurstTimeLength.
+		 */
+		Time          GetConfiguredMeanBurstLength() const;
+
+		/**
+		 * \brief Return the mean length of the bursts started so far.
+		 */
+		Time          GetEffectiveMeanBurstLength() const;
+
+		/**
+		 * \brief Assign a fixed random variable stream number to the random variables
+		 * used by this model.
+		 *
+		 * \param stream first stream index to use
+		 * \return the number of stream indices assigned by this model
+		 */
+		int64_t       AssignStreams (int64_t stream);
+
+		/**
+		 * \brief Save the state of the application to a binary blob: the next
+		 * burst arrival, the end and length of every active burst, the pending
+		 * send, the pacer credit, the counters and the position of every random
+		 * variable stream. The streams must have been fixed with AssignStreams.
+		 *
+		 * \return the saved state
+		 */
+		std::vector<uint8_t> Checkpoint () const;
+
+		/**
+		 * \brief Resume from a checkpoint at the next start, instead of from
+		 * an empty system.
+		 *
+		 * The application must have the same attributes and streams as the
+		 * one that was saved. Its streams are moved to the saved positions by
+		 * drawing the same number of values again, and all saved times are
+		 * shifted by the start time minus the checkpoint time, so that the
+		 * traffic that follows is the one the saved application would have
+		 * sent.
+		 *
+		 * \param state a blob returned by Checkpoint
+		 */
+		void          Restore (const std::vector<uint8_t> &state);
+
+		/**
+		 * \brief Add a destination to the set from which FlowPerBurst draws
+		 * the destination of each burst. With an empty set every burst goes
+		 * to Remote.
+		 */
+		void          AddRemote (Address remote);
 
 	protected:
 		virtual void DoDispose ();
@@ -118,56 +275,208 @@ namespace ns3 {
 		// Event handlers
 		void StartSending();
 		void StopSending();
-		void SendPacket();
 
 		Ptr<Socket>     m_socket;						// Associated socket
 		TypeId          m_protocolTid;					// protocol type id
 		Address         m_peer;							// Peer address
 		bool            m_connected;					// True if connected
 
-		uint32_t        m_totalBytes;					// Total bytes sent so far
+		uint64_t        m_totalBytes;					// Total bytes sent so far
+		uint64_t        m_totalPackets;					// Total packets sent so far
+		uint64_t        m_totalBursts;					// Total bursts started so far
+		uint64_t        m_totalEvents;					// Total simulator events scheduled so far
 
 		Time            m_lastStartTime;				// Time last packet sent
 		EventId         m_startStopEvent;				// Event id for next start or stop event
-		EventId         m_sendEvent;					// Event id of pending "send packet" event
 		EventId			m_getUtilization;				// Event id to get the utilization factor
-		EventId			m_PoissonArrival;				// Event id for next burst arrival
-		EventId			m_ppbp;							// Event id for the length of a pending burst arrival
-		EventId			m_ParetoDeparture;				// Event id of burst departure
+		EventId			m_timer;						// Single pending event: next arrival, departure or send
+
+		// Policies of m_engine, backed by the random variables, sockets and
+		// traces of the application
+		struct Arrivals
+		{
+			PPBPApplication *app;
+			Arrivals (PPBPApplication *a = 0) : app (a) {}
+			int64_t Next (int64_t now) { return app->DrawArrival ().GetTimeStep (); }
+		};
+		struct Lengths
+		{
+			PPBPApplication *app;
+			Lengths (PPBPApplication *a = 0) : app (a) {}
+			int64_t Next () { return app->DrawBurstLength ().GetTimeStep (); }
+		};
+		struct Sizes
+		{
+			PPBPApplication *app;
+			Sizes (PPBPApplication *a = 0) : app (a) {}
+			bool IsFixed () const { return app->m_sizes.IsEmpty (); }
+			uint32_t Next () { return app->DrawSizeClass (); }
+			uint64_t GetBits (uint32_t sizeClass) const
+			{
+				return (uint64_t) (app->GetSize (sizeClass) + app->m_headerOverhead) * 8;
+			}
+		};
+		struct Sink
+		{
+			PPBPApplication *app;
+			Sink (PPBPApplication *a = 0) : app (a) {}
+			uint32_t BurstStart (int64_t now, int64_t length) { return app->PoissonArrival (TimeStep (length)); }
+			void BurstEnd (int64_t now, int64_t length, uint32_t flow) { app->ParetoDeparture (TimeStep (length), flow); }
+			void Send (int64_t now, const uint32_t *sizeClasses, uint32_t packets) { app->SendPacket (sizeClasses, packets); }
+		};
+		typedef PPBPEngine<Arrivals, Lengths, Sizes, Sink> Engine;
+		Engine			m_engine;						// Bursts, pacer and packet trains
 
 		uint32_t		m_pktSize;						// Size of packets
+		uint32_t		m_headerOverhead;				// Bytes added to each packet when pacing
+		bool			m_seqTsHeader;					// Prepend a SeqTsHeader to each packet
+		uint32_t		m_seq;							// Sequence number of the next packet
+		std::vector<Ptr<Packet> >	m_packetTemplates;	// Payload copied for every packet sent, per size
+		std::string		m_sizeSpec;						// PacketSizeDistribution
+		std::string		m_sizeFile;						// PacketSizeFile
+		PPBPSizeDistribution	m_sizes;				// Packet sizes, empty for PacketSize
+
+		bool			m_trainMode;					// Send packets in back-to-back trains
+		Time			m_maxTrainJitter;				// Bound on the timing error within a train
+		uint32_t		m_maxTrainLength;				// Upper bound on the packets per train
+
+		bool			m_fluidMode;					// Only trace the rate process, send no packets
+		Time			m_fgnSlot;						// Slot of the fGn approximation, zero for none
+		uint32_t		m_fgnBlockSize;					// Slots per fGn path
+		PPBPFgnGenerator	m_fgn;						// Circulant embedding for H
+		std::vector<double>	m_fgnNormals;				// Normals of the next block
+		std::vector<double>	m_fgnSamples;				// fGn of the current block
+		uint32_t		m_fgnNext;						// Next sample of m_fgnSamples
+		double			m_fgnMean;						// lambda_p x Ton of the current block
+		Time			m_nextSlot;						// Start of the next fGn slot
+		bool			m_stationaryStart;				// Start with the bursts of the steady state
+
+		bool			m_flowPerBurst;					// Send each burst on a socket of its own
+		uint32_t		m_socketPoolSize;				// Sockets created at start for the bursts
+		bool			m_backpressure;					// Only send what the socket accepts
+		uint64_t		m_generatedBytes;				// Total bytes generated by the bursts
+		uint64_t		m_backlogBytes;					// Bytes generated but not sent
+		std::vector<Address>	m_remotes;				// Destinations drawn for the bursts
+		std::vector<Ptr<Socket> >	m_pool;				// Socket of each flow (FlowPerBurst)
+		std::vector<uint32_t>	m_flowRemote;			// Index into m_remotes, per flow
+		std::vector<uint32_t>	m_freeFlows;			// Flows not used by a burst
+		std::vector<uint32_t>	m_activeFlows;			// Flows of the active bursts
+		std::vector<uint32_t>	m_flowPosition;			// Index into m_activeFlows, per flow
+		std::vector<uint64_t>	m_flowBacklog;			// Unsent bytes, per flow (Backpressure)
+		std::deque<uint32_t>	m_backloggedFlows;		// Flows with unsent bytes, in send order
+		uint32_t		m_nextFlow;						// Next active burst to send a packet
+
+		std::string		m_pcapngFile;					// File written instead of a socket
+		uint32_t		m_pcapngSnapLength;				// Bytes captured per frame
+		Ptr<PPBPPcapngWriter>	m_pcapng;				// Writer of m_pcapngFile, shared by file
+		uint32_t		m_pcapngSource;					// Index of this application in the writer
+
+		TracedValue<double>	m_rate;						// Instantaneous offered rate n(t) x r (bit/s)
 
 		TracedCallback< Ptr<const Packet> > m_txTrace;	// Trace callback for each sent packet
+		TracedCallback<Time>	m_burstStartTrace;		// Burst length, when a burst starts
+		TracedCallback<Time>	m_burstEndTrace;		// Burst length, when a burst ends
 
 		Ptr<RandomVariableStream>	m_burstArrivals;	// Mean rate of burst arrivals
 		Ptr<RandomVariableStream>   m_burstLength;		// Mean burst time length
+		Ptr<PPBPRateProfile>		m_rateProfile;		// Multiplier of the arrival rate, or null
+		Time			m_maxBurstLength;				// Bound of the burst lengths, zero for none
+		double			m_boundedMean;					// Mean the bounded scale was solved for
+		double			m_boundedShape;					// Shape the bounded scale was solved for
+		double			m_boundedScale;					// Pareto scale of the bounded lengths
+		double			m_configuredMean;				// Last mean burst length drawn (s)
+		double			m_burstLengthSum;				// Lengths of the bursts started so far (s)
 		DataRate        m_cbrRate;						// Burst intensity (constant bit-rate)
 
+		Ptr<ExponentialRandomVariable>	m_arrivalVariate;	// Inter-burst intervals
+		Ptr<ParetoRandomVariable>		m_lengthVariate;	// Burst lengths
+		Ptr<UniformRandomVariable>		m_sizeVariate;		// Packet sizes
+		uint32_t		m_variateBlockSize;				// Variates per block, 0 to draw them one by one
+		uint64_t		m_burstArrivalsDraws;			// Values drawn from each stream, for Restore
+		uint64_t		m_burstLengthDraws;
+		uint64_t		m_arrivalDraws;
+		uint64_t		m_lengthDraws;
+		uint64_t		m_sizeDraws;
+		std::vector<uint8_t>	m_restoreState;			// Checkpoint to resume from at the next start
+		PPBPVariateBuffer	m_variates;					// Block-sampled intervals and lengths
+
 		double			m_h;							// Hurst parameter	(Pareto distribution)
 		double			m_shape;						// Shape			(Pareto distribution)
 		double			m_timeSlot;						// The time slot
-		int				m_activebursts;					// Number of active bursts at time t
-		bool			m_offPeriod;
+		TracedValue<uint32_t>	m_activebursts;			// Number of active bursts at time t
 
 	private:
+		void SetHurst(double h);
+		double GetHurst() const;
+		void SetPacketSize(uint32_t size);
+		uint32_t GetPacketSize() const;
+		void SetPacketSizeDistribution(std::string spec);
+		std::string GetPacketSizeDistribution() const;
+		void SetPacketSizeFile(std::string fileName);
+		std::string GetPacketSizeFile() const;
+		uint32_t GetSize(uint32_t sizeClass) const;
+		void SetBurstIntensity(DataRate rate);
+		DataRate GetBurstIntensity() const;
+		void SetHeaderOverhead(uint32_t overhead);
+		uint32_t GetHeaderOverhead() const;
+		void UpdatePacer();
+		void SetVariateBlockSize(uint32_t size);
+		uint32_t GetVariateBlockSize() const;
+		void SetSeqTsHeader(bool enable);
+		bool GetSeqTsHeader() const;
+
 		void ScheduleStartEvent();
 		void ScheduleStopEvent();
 		void ConnectionSucceeded(Ptr<Socket>);
 		void ConnectionFailed(Ptr<Socket>);
 
+		/**
+		 * \brief Handle every event due now and re-arm m_timer. The generator
+		 * keeps one simulator event per application. Burst end times are held
+		 * in m_engine instead of the simulator queue, and m_timer always
+		 * points at the earliest of the next arrival, the next departure and
+		 * the next packet transmission.
+		 */
+		void ProcessEvents();
+		void ScheduleTimer();
+
 		/**
 		 * \ Functions that allows to keep track of the current number of active bursts at time t, nt,
 		 * taking into account that their arrival process follows a Poisson process and that their
-		 * length is determined by a Pareto distribution.
+		 * length is determined by a Pareto distribution. m_engine draws the next arrival and its
+		 * length with DrawArrival and DrawBurstLength, and reports the bursts to PoissonArrival
+		 * and ParetoDeparture.
 		 */
-		void PPBP();
-		void PoissonArrival();
-		void ParetoDeparture();
+		Time DrawArrival();
+		Time DrawBurstLength();
+		uint32_t DrawSizeClass();
+		void StationaryStart();
+		void FgnSlot();
+		void DrawFgnBlock();
+		Time DrawProfileArrival(double rate);
+		void RestoreState();
+		Ptr<Socket> CreatePoolSocket();
+		void ResetFlows();
+		uint32_t AcquireFlow();
+		void ReleaseFlow(uint32_t flow);
+		void ConnectFlow(uint32_t flow);
+		uint32_t NextFlow();
+		bool TracksBursts() const;
+		Ptr<Packet> MakePacket(uint32_t sizeClass);
+		void Drain();
+		void DataSend(Ptr<Socket>, uint32_t);
+		double DrawExponential(double mean);
+		double DrawPareto(double scale, double bound);
+		uint32_t PoissonArrival(Time length);
+		void ParetoDeparture(Time length, uint32_t flow);
+		void UpdateRate();
 
 		/**
-		 * \ Function thet generates the packets departure at a constant bit-rate nt x r.
+		 * \ Sends the packet train that m_engine paces at a constant bit-rate nt x r.
+		 * In train mode, K packets leave back-to-back every K packet intervals, with K
+		 * chosen so that no packet is more than MaxTrainJitter away from its paced time.
 		 */
-		void ScheduleNextTx();
+		void SendPacket(const uint32_t *sizeClasses, uint32_t packets);
 	};
 
 } // namespace ns3
@@ -0,0 +1,345 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This script measures the cost of the PPBP generator. It sweeps the number
+*  of PPBP applications and their parameters, given as comma-separated lists,
+*  and runs every combination in a child process of its own so that the peak
+*  RSS of one point does not carry over to the next. For each point it appends
+*  one line to a CSV file with the wall-clock time per simulated second, the
+*  simulator events executed, the peak scheduler queue size, the peak RSS and
+*  the packets sent per simulated and per wall-clock second.
+*  By default the applications send to an address without a route, so the
+*  packets are dropped by the IP layer and the figures are dominated by the
+*  generator; with --network=true they cross a point-to-point link to a sink.
+*  With --fgnSlot the applications use the fractional Gaussian noise
+*  approximation instead of simulating every burst. --variateBlockSize sweeps
+*  the VariateBlockSize attribute (0 draws every variate by a call of its own).
+*  --mux=0,1 compares N PPBPApplications against one PPBPMuxApplication with
+*  N logical sources; the CSV then also reports the install time, and the
+*  offered bit-rate next to the mean n x lambda_p x T_on x r expected of the
+*  aggregate (the mux ignores --fgnSlot and --variateBlockSize).
+*  Example run: Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-benchmark --apps=1,10,100 --H=0.6,0.8 --output=ppbp-benchmark.csv"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/map-scheduler.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPBenchmark");
+
+namespace ns3 {
+
+/**
+ * \brief A MapScheduler that records the largest number of pending events.
+ */
+class PPBPBenchmarkScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  virtual void Insert (const Event &ev);
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+  static uint64_t GetPeakSize (void);
+
+private:
+  static uint64_t m_size;
+  static uint64_t m_peak;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (PPBPBenchmarkScheduler);
+
+uint64_t PPBPBenchmarkScheduler::m_size = 0;
+uint64_t PPBPBenchmarkScheduler::m_peak = 0;
+
+TypeId
+PPBPBenchmarkScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PPBPBenchmarkScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<PPBPBenchmarkScheduler> ()
+  ;
+  return tid;
+}
+
+void
+PPBPBenchmarkScheduler::Insert (const Event &ev)
+{
+  MapScheduler::Insert (ev);
+  if (++m_size > m_peak)
+    {
+      m_peak = m_size;
+    }
+}
+
+Scheduler::Event
+PPBPBenchmarkScheduler::RemoveNext (void)
+{
+  --m_size;
+  return MapScheduler::RemoveNext ();
+}
+
+void
+PPBPBenchmarkScheduler::Remove (const Event &ev)
+{
+  --m_size;
+  MapScheduler::Remove (ev);
+}
+
+uint64_t
+PPBPBenchmarkScheduler::GetPeakSize (void)
+{
+  return m_peak;
+}
+
+} // namespace ns3
+
+static uint64_t g_packets = 0;
+static uint64_t g_bytes = 0;
+
+static void
+CountTx (Ptr<const Packet> packet)
+{
+  ++g_packets;
+  g_bytes += packet->GetSize ();
+}
+
+template <typename T>
+static std::vector<T>
+SplitList (std::string list)
+{
+  std::vector<T> values;
+  std::istringstream in (list);
+  std::string item;
+  while (std::getline (in, item, ','))
+    {
+      std::istringstream value (item);
+      T v;
+      value >> v;
+      values.push_back (v);
+    }
+  return values;
+}
+
+struct BenchmarkPoint
+{
+  uint32_t apps;
+  double hurst;
+  double burstArrivals;
+  double burstLength;
+  std::string burstIntensity;
+  uint32_t variateBlockSize;
+  bool mux;
+};
+
+static void
+RunPoint (const BenchmarkPoint &p, double simulationTime, bool network, double fgnSlot, std::string output)
+{
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::PPBPBenchmarkScheduler");
+  Simulator::SetScheduler (scheduler);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  uint32_t socketPort = 9;
+  Ipv4Address remote ("10.1.1.2");
+  if (network)
+    {
+      PointToPointHelper p2p;
+      p2p.SetDeviceAttribute ("DataRate", StringValue ("100Gbps"));
+      p2p.SetChannelAttribute ("Delay", StringValue ("1us"));
+      NetDeviceContainer devices = p2p.Install (nodes);
+
+      Ipv4AddressHelper address;
+      address.SetBase ("10.1.1.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      remote = interfaces.GetAddress (1);
+
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), socketPort));
+      sink.Install (nodes.Get (1));
+    }
+
+  uint32_t packetSize = 1470;
+  uint32_t headerOverhead = 30;
+  std::chrono::steady_clock::time_point installStart = std::chrono::steady_clock::now ();
+  ApplicationContainer apps;
+  if (p.mux)
+    {
+      PPBPMuxHelper mux ("ns3::UdpSocketFactory");
+      mux.SetAttribute ("HeaderOverhead", UintegerValue (headerOverhead));
+      for (uint32_t i = 0; i < p.apps; ++i)
+        {
+          mux.AddSource (InetSocketAddress (remote, socketPort), p.burstArrivals, p.burstLength,
+                         p.hurst, DataRate (p.burstIntensity), packetSize);
+        }
+      apps = mux.Install (nodes.Get (0));
+      mux.AssignStreams (nodes, 0);
+    }
+  else
+    {
+      PPBPHelper ppbp = PPBPHelper ("ns3::UdpSocketFactory", InetSocketAddress (remote, socketPort));
+      ppbp.SetAttribute ("H", DoubleValue (p.hurst));
+      ppbp.SetAttribute ("BurstIntensity", DataRateValue (DataRate (p.burstIntensity)));
+      std::ostringstream arrivals;
+      arrivals << "ns3::ConstantRandomVariable[Constant=" << p.burstArrivals << "]";
+      ppbp.SetAttribute ("MeanBurstArrivals", StringValue (arrivals.str ()));
+      std::ostringstream length;
+      length << "ns3::ConstantRandomVariable[Constant=" << p.burstLength << "]";
+      ppbp.SetAttribute ("MeanBurstTimeLength", StringValue (length.str ()));
+      ppbp.SetAttribute ("FgnSlot", TimeValue (Seconds (fgnSlot)));
+      ppbp.SetAttribute ("VariateBlockSize", UintegerValue (p.variateBlockSize));
+      ppbp.SetAttribute ("PacketSize", UintegerValue (packetSize));
+      ppbp.SetAttribute ("HeaderOverhead", UintegerValue (headerOverhead));
+
+      for (uint32_t i = 0; i < p.apps; ++i)
+        {
+          apps.Add (ppbp.Install (nodes.Get (0)));
+        }
+      ppbp.AssignStreams (nodes, 0);
+    }
+  double install = std::chrono::duration<double> (std::chrono::steady_clock::now () - installStart).count ();
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (simulationTime));
+  for (uint32_t i = 0; i < apps.GetN (); ++i)
+    {
+      apps.Get (i)->TraceConnectWithoutContext ("Tx", MakeCallback (&CountTx));
+    }
+
+  Simulator::Stop (Seconds (simulationTime));
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  // Bit-rate on the wire, headers included, against its stationary mean
+  double rate = (g_bytes + g_packets * headerOverhead) * 8 / simulationTime;
+  double expected = p.apps * p.burstArrivals * p.burstLength * DataRate (p.burstIntensity).GetBitRate ();
+  NS_LOG_UNCOND ("  offered " << rate << " bit/s, expected " << expected << " bit/s");
+
+  std::ofstream csv (output.c_str (), std::ios::app);
+  csv << p.apps << "," << p.hurst << "," << p.burstArrivals << "," << p.burstLength << ","
+      << p.burstIntensity << "," << p.variateBlockSize << "," << p.mux << "," << simulationTime << ","
+      << install << "," << wall << "," << wall / simulationTime << "," << events << ","
+      << PPBPBenchmarkScheduler::GetPeakSize () << "," << usage.ru_maxrss << ","
+      << g_packets << "," << g_packets / simulationTime << ","
+      << (wall > 0 ? g_packets / wall : 0) << "," << rate << "," << expected << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  double simulationTime = 10; //seconds
+  std::string output = "ppbp-benchmark.csv";
+  bool network = false;
+  double fgnSlot = 0; //seconds
+  std::string appsList = "1,10,100";
+  std::string hurstList = "0.7";
+  std::string arrivalsList = "20";
+  std::string lengthList = "0.2";
+  std::string intensityList = "1Mb/s";
+  std::string blockSizeList = "0";
+  std::string muxList = "0";
+
+  CommandLine cmd;
+  cmd.AddValue ("simulationTime", "Simulated time of each point (s)", simulationTime);
+  cmd.AddValue ("output", "CSV file to write", output);
+  cmd.AddValue ("network", "Send across a point-to-point link instead of dropping at the IP layer", network);
+  cmd.AddValue ("fgnSlot", "Slot of the fGn approximation (s), 0 to simulate every burst", fgnSlot);
+  cmd.AddValue ("apps", "Numbers of PPBP applications", appsList);
+  cmd.AddValue ("H", "Hurst parameters", hurstList);
+  cmd.AddValue ("burstArrivals", "Mean rates of burst arrivals (1/s)", arrivalsList);
+  cmd.AddValue ("burstLength", "Mean burst time lengths (s)", lengthList);
+  cmd.AddValue ("burstIntensity", "Data rates of each burst", intensityList);
+  cmd.AddValue ("variateBlockSize", "Variate block sizes (0 draws them one by one)", blockSizeList);
+  cmd.AddValue ("mux", "1 to run the sources as one PPBPMuxApplication, 0 as one application each", muxList);
+  cmd.Parse (argc, argv);
+
+  Time::SetResolution (Time::NS);
+
+  std::vector<uint32_t> apps = SplitList<uint32_t> (appsList);
+  std::vector<double> hurst = SplitList<double> (hurstList);
+  std::vector<double> arrivals = SplitList<double> (arrivalsList);
+  std::vector<double> length = SplitList<double> (lengthList);
+  std::vector<std::string> intensity = SplitList<std::string> (intensityList);
+  std::vector<uint32_t> blockSize = SplitList<uint32_t> (blockSizeList);
+  std::vector<uint32_t> mux = SplitList<uint32_t> (muxList);
+
+  std::ofstream csv (output.c_str (), std::ios::trunc);
+  csv << "apps,H,burstArrivals,burstLength,burstIntensity,variateBlockSize,mux,simulationTime,"
+      << "installSeconds,wallSeconds,wallPerSimSecond,events,peakQueue,peakRssKb,packets,"
+      << "packetsPerSimSecond,packetsPerWallSecond,bitsPerSimSecond,expectedBitsPerSimSecond" << std::endl;
+  csv.close ();
+
+  for (uint32_t a = 0; a < apps.size (); ++a)
+    for (uint32_t h = 0; h < hurst.size (); ++h)
+      for (uint32_t l = 0; l < arrivals.size (); ++l)
+        for (uint32_t t = 0; t < length.size (); ++t)
+          for (uint32_t r = 0; r < intensity.size (); ++r)
+            for (uint32_t b = 0; b < blockSize.size (); ++b)
+              for (uint32_t m = 0; m < mux.size (); ++m)
+                {
+                  BenchmarkPoint p;
+                  p.apps = apps[a];
+                  p.hurst = hurst[h];
+                  p.burstArrivals = arrivals[l];
+                  p.burstLength = length[t];
+                  p.burstIntensity = intensity[r];
+                  p.variateBlockSize = blockSize[b];
+                  p.mux = mux[m] != 0;
+
+                  NS_LOG_UNCOND ("apps=" << p.apps << " H=" << p.hurst << " burstArrivals=" << p.burstArrivals
+                                 << " burstLength=" << p.burstLength << " burstIntensity=" << p.burstIntensity
+                                 << " variateBlockSize=" << p.variateBlockSize << " mux=" << p.mux);
+                  std::fflush (stdout);
+                  pid_t pid = fork ();
+                  if (pid == 0)
+                    {
+                      RunPoint (p, simulationTime, network, fgnSlot, output);
+                      _exit (0);
+                    }
+                  int status = 0;
+                  if (pid < 0 || waitpid (pid, &status, 0) != pid || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+                    {
+                      NS_LOG_UNCOND ("  point failed");
+                    }
+                }
+
+  NS_LOG_UNCOND ("Wrote " << output);
+  return 0;
+}
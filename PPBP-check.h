@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Checks shared by the PPBP check programs (PPBP-variate-test,
+*  PPBP-size-test, PPBP-fgn-test). Copy it to the scratch folder next to them.
+*/
+
+#ifndef __PPBP_check_h__
+#define __PPBP_check_h__
+
+#include "ns3/log.h"
+#include <cmath>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup PPBP
+ *
+ * \return false once any PPBPCheck of the program has failed.
+ */
+inline bool &
+PPBPCheckPassed (void)
+{
+  static bool passed = true;
+  return passed;
+}
+
+/**
+ * \ingroup PPBP
+ *
+ * \brief Print and record whether a value lies within tolerance of its
+ * expected value.
+ */
+inline void
+PPBPCheck (std::string what, double value, double expected, double tolerance)
+{
+  bool ok = std::fabs (value - expected) <= tolerance;
+  NS_LOG_UNCOND ((ok ? "  ok   " : "  FAIL ") << what << " " << value << " (expected " << expected
+                 << " +- " << tolerance << ")");
+  PPBPCheckPassed () = PPBPCheckPassed () && ok;
+}
+
+/**
+ * \ingroup PPBP
+ *
+ * \brief Print the overall outcome of the checks.
+ * \return the exit status of the program: 0 if every check passed.
+ */
+inline int
+PPBPCheckSummary (void)
+{
+  NS_LOG_UNCOND ((PPBPCheckPassed () ? "All checks passed" : "Some checks failed"));
+  return PPBPCheckPassed () ? 0 : 1;
+}
+
+} // namespace ns3
+
+#endif /* __PPBP_check_h__ */
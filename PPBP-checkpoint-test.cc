@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This script checks PPBPApplication checkpoints. It runs one PPBP source
+*  for 2 x checkpointTime, then runs it again up to checkpointTime and saves
+*  its state, and finally resumes that state in a fresh simulation started at
+*  checkpointTime. The packets sent after checkpointTime by the first and the
+*  last run must be the same.
+*  Command line parameters are the checkpointTime, H and the checkpoint file.
+*  Example run: Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-checkpoint-test --checkpointTime=100 --H=0.9"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include <fstream>
+#include <iterator>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPCheckpointExample");
+
+static std::vector<int64_t> g_txTimes;
+
+void TxTrace (Ptr<const Packet> packet)
+{
+  g_txTimes.push_back (Simulator::Now ().GetTimeStep ());
+}
+
+static Ptr<PPBPApplication>
+Setup (double hurst, double start, double stop)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  // No route: the packets are only counted by the Tx trace
+  PPBPHelper ppbp = PPBPHelper ("ns3::UdpSocketFactory",
+                                InetSocketAddress (Ipv4Address ("10.1.1.2"), 9));
+  ppbp.SetAttribute ("H", DoubleValue (hurst));
+  ApplicationContainer apps = ppbp.Install (nodes.Get (0));
+  ppbp.AssignStreams (nodes, 0);
+  apps.Start (Seconds (start));
+  apps.Stop (Seconds (stop));
+  apps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&TxTrace));
+  return DynamicCast<PPBPApplication> (apps.Get (0));
+}
+
+static void
+SaveCheckpoint (Ptr<PPBPApplication> app, std::string file)
+{
+  std::vector<uint8_t> state = app->Checkpoint ();
+  std::ofstream out (file.c_str (), std::ios::binary);
+  out.write (reinterpret_cast<const char *> (&state[0]), state.size ());
+  NS_LOG_UNCOND ("Saved " << state.size () << " bytes at " << Simulator::Now ().GetSeconds () << " s");
+}
+
+static std::vector<int64_t>
+After (const std::vector<int64_t> &times, int64_t t)
+{
+  std::vector<int64_t> after;
+  for (uint32_t i = 0; i < times.size (); ++i)
+    {
+      if (times[i] > t)
+        {
+          after.push_back (times[i]);
+        }
+    }
+  return after;
+}
+
+int
+main (int argc, char *argv[])
+{
+  double checkpointTime = 50; //seconds
+  double hurst = 0.8;
+  std::string file = "ppbp.checkpoint";
+
+  CommandLine cmd;
+  cmd.AddValue ("checkpointTime", "Time of the checkpoint (s)", checkpointTime);
+  cmd.AddValue ("H", "Hurst parameter", hurst);
+  cmd.AddValue ("file", "Checkpoint file", file);
+  cmd.Parse (argc, argv);
+
+  Time::SetResolution (Time::NS);
+  double stopTime = 2 * checkpointTime;
+  int64_t checkpointStep = Seconds (checkpointTime).GetTimeStep ();
+
+  // Uninterrupted reference run
+  Setup (hurst, 0, stopTime);
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  std::vector<int64_t> reference = After (g_txTimes, checkpointStep);
+
+  // Run up to the checkpoint and save the state
+  g_txTimes.clear ();
+  Ptr<PPBPApplication> app = Setup (hurst, 0, stopTime);
+  Simulator::Schedule (Seconds (checkpointTime), &SaveCheckpoint, app, file);
+  Simulator::Stop (Seconds (checkpointTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // Resume the saved state in a fresh simulation
+  g_txTimes.clear ();
+  std::ifstream in (file.c_str (), std::ios::binary);
+  std::vector<uint8_t> state ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+  app = Setup (hurst, checkpointTime, stopTime);
+  app->Restore (state);
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  std::vector<int64_t> resumed = After (g_txTimes, checkpointStep);
+
+  if (resumed == reference)
+    {
+      NS_LOG_UNCOND ("Resumed run matches: " << resumed.size () << " packets after the checkpoint");
+      return 0;
+    }
+  NS_LOG_UNCOND ("Resumed run differs: " << resumed.size () << " packets instead of " << reference.size ());
+  return 1;
+}
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This microbenchmark runs the PPBP process of PPBPApplication in a bare
+*  PPBPEngine, with std::mt19937_64 variates and a sink that only counts,
+*  so that no simulator event, packet or random variable stream is involved.
+*  Every source has its own engine and generator (seeded seed + source
+*  index) and runs for the whole duration in turn. It reports the bursts and
+*  packets generated against the expected mean, and the wall-clock cost per
+*  packet: the cost of the process itself, below what PPBP-benchmark
+*  measures with applications.
+*  Example run: Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-engine-benchmark --sources=100 --duration=100 --H=0.8"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include "PPBP-engine.h"
+#include <chrono>
+#include <random>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPEngineBenchmark");
+
+typedef PPBPEngine<PPBPPoissonArrivals<std::mt19937_64>, PPBPParetoLengths<std::mt19937_64>,
+                   PPBPFixedSize, PPBPCountingSink> BenchmarkEngine;
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t sources = 10;
+  double duration = 100; //seconds
+  double hurst = 0.7;
+  double burstArrivals = 20;
+  double burstLength = 0.2;
+  std::string burstIntensity = "1Mb/s";
+  uint32_t packetSize = 1470;
+  uint32_t headerOverhead = 30;
+  double maxTrainJitter = 0; //seconds
+  uint32_t maxTrainLength = 64;
+  uint64_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("sources", "Number of independent sources", sources);
+  cmd.AddValue ("duration", "Time span generated per source (s)", duration);
+  cmd.AddValue ("H", "Hurst parameter", hurst);
+  cmd.AddValue ("burstArrivals", "Mean rate of burst arrivals (1/s)", burstArrivals);
+  cmd.AddValue ("burstLength", "Mean burst time length (s)", burstLength);
+  cmd.AddValue ("burstIntensity", "Data rate of each burst", burstIntensity);
+  cmd.AddValue ("packetSize", "Size of the packets (bytes)", packetSize);
+  cmd.AddValue ("headerOverhead", "Bytes of lower-layer headers charged per packet", headerOverhead);
+  cmd.AddValue ("maxTrainJitter", "Send trains with at most this timing error (s), 0 for single packets", maxTrainJitter);
+  cmd.AddValue ("maxTrainLength", "Upper bound on the packets per train", maxTrainLength);
+  cmd.AddValue ("seed", "Seed of the first source", seed);
+  cmd.Parse (argc, argv);
+
+  Time::SetResolution (Time::NS);
+  int64_t stepsPerSecond = Seconds (1).GetTimeStep ();
+  int64_t until = Seconds (duration).GetTimeStep ();
+  uint64_t bits = (packetSize + headerOverhead) * 8;
+  uint64_t rate = DataRate (burstIntensity).GetBitRate ();
+
+  uint64_t bursts = 0;
+  uint64_t packets = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < sources; ++i)
+    {
+      std::mt19937_64 rng (seed + i);
+      BenchmarkEngine engine (PPBPPoissonArrivals<std::mt19937_64> (&rng, burstArrivals, stepsPerSecond),
+                              PPBPParetoLengths<std::mt19937_64> (&rng, burstLength, hurst, stepsPerSecond),
+                              PPBPFixedSize (bits), PPBPCountingSink ());
+      engine.GetPacer ().SetPacketBits (bits, stepsPerSecond);
+      engine.GetPacer ().SetBurstRate (rate);
+      engine.SetTrains (maxTrainJitter > 0, Seconds (maxTrainJitter).GetTimeStep (), maxTrainLength);
+      engine.Start (0);
+      engine.Run (until);
+      bursts += engine.GetSink ().GetBursts ();
+      packets += engine.GetSink ().GetPackets ();
+    }
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  // lambda = Ton x lambda_p x r, in packets
+  double expected = sources * duration * burstArrivals * burstLength * rate / bits;
+  NS_LOG_UNCOND (sources << " source(s) x " << duration << " s: " << bursts << " bursts, "
+                 << packets << " packets (mean " << expected << ")");
+  NS_LOG_UNCOND (wall << " s wall-clock, " << (packets ? wall * 1e9 / packets : 0) << " ns per packet, "
+                 << (wall > 0 ? packets / wall / 1e6 : 0) << " Mpackets/s");
+  return 0;
+}
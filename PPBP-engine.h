@@ -0,0 +1,508 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_engine_h__
+#define __PPBP_engine_h__
+
+#include "PPBP-pacer.h"
+#include <stdint.h>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief The PPBP process, free of the simulator: burst arrivals, burst
+	 *        departures and the packets they pace, in integer time steps.
+	 *
+	 * The engine holds the next burst arrival, the active bursts in a heap
+	 * ordered by end time and a PPBPPacer for the n(t) x r departures.
+	 * Process (now) handles, in this order, the bursts ending by now, the
+	 * burst arriving by now and the packet train due by now, and
+	 * GetNextEvent () tells when to call it again; Run (until) loops on both
+	 * for a standalone generator. What varies between users is given as
+	 * compile-time policies, so the calls in the loop are inlined:
+	 *
+	 * - Arrivals: int64_t Next (int64_t now), the time step of the burst
+	 *   arrival that follows now (INT64_MAX for none);
+	 * - Lengths: int64_t Next (), the length of that burst in time steps,
+	 *   drawn right after its arrival time;
+	 * - Sizes: bool IsFixed () const, true when every packet is of the
+	 *   size the pacer was set up with; uint32_t Next (), the size class of
+	 *   the next packet; uint64_t GetBits (uint32_t sizeClass) const, the
+	 *   bits charged for a packet of that class;
+	 * - Sink: uint32_t BurstStart (int64_t now, int64_t length), returning a
+	 *   tag kept with the burst; void BurstEnd (int64_t now, int64_t length,
+	 *   uint32_t tag); void Send (int64_t now, const uint32_t *sizeClasses,
+	 *   uint32_t packets), for every train (size classes are all 0 when the
+	 *   sizes are fixed).
+	 *
+	 * The engine calls the sink after it has updated its number of active
+	 * bursts, so GetActive () can be read from BurstStart and BurstEnd.
+	 * PPBPPoissonArrivals, PPBPParetoLengths, PPBPFixedSize and
+	 * PPBPCountingSink are policies with no ns-3 dependency.
+	 */
+	template <class Arrivals, class Lengths, class Sizes, class Sink>
+	class PPBPEngine
+	{
+	public:
+		struct Burst
+		{
+			int64_t		end;							// End time of the burst
+			int64_t		length;							// Length of the burst
+			uint32_t	tag;							// Tag returned by Sink::BurstStart
+
+			Burst (int64_t e, int64_t l, uint32_t t) : end (e), length (l), tag (t) {}
+			bool operator> (const Burst &o) const
+			{
+				if (end != o.end) return end > o.end;
+				if (length != o.length) return length > o.length;
+				return tag > o.tag;
+			}
+		};
+		typedef std::priority_queue<Burst, std::vector<Burst>, std::greater<Burst> > Departures;
+
+		PPBPEngine ()
+			: m_fluid (false),
+			  m_trainMode (false),
+			  m_maxTrainJitter (0),
+			  m_maxTrainLength (1)
+		{
+			Reset (0);
+		}
+
+		PPBPEngine (const Arrivals &arrivals, const Lengths &lengths, const Sizes &sizes, const Sink &sink)
+			: m_arrivals (arrivals),
+			  m_lengths (lengths),
+			  m_sizes (sizes),
+			  m_sink (sink),
+			  m_fluid (false),
+			  m_trainMode (false),
+			  m_maxTrainJitter (0),
+			  m_maxTrainLength (1)
+		{
+			Reset (0);
+		}
+
+		Arrivals &GetArrivals () { return m_arrivals; }
+		Lengths &GetLengths () { return m_lengths; }
+		Sizes &GetSizes () { return m_sizes; }
+		Sink &GetSink () { return m_sink; }
+
+		/**
+		 * \brief The pacer, to set the packet bits and the burst rate.
+		 */
+		PPBPPacer &GetPacer () { return m_pacer; }
+		const PPBPPacer &GetPacer () const { return m_pacer; }
+
+		/**
+		 * \brief Only follow the bursts and send no packet.
+		 */
+		void SetFluid (bool fluid) { m_fluid = fluid; }
+
+		/**
+		 * \brief Send trains of back-to-back packets, of at most max packets
+		 * and with no packet more than jitter time steps from its paced time.
+		 */
+		void SetTrains (bool enabled, int64_t jitter, uint32_t max)
+		{
+			m_trainMode = enabled;
+			m_maxTrainJitter = jitter;
+			m_maxTrainLength = max;
+		}
+
+		/**
+		 * \brief Drop the active bursts, the pending train and the pacer
+		 * credit; nothing is drawn.
+		 */
+		void Reset (int64_t now)
+		{
+			m_departures = Departures ();
+			m_active = 0;
+			m_nextArrival = std::numeric_limits<int64_t>::max ();
+			m_nextLength = 0;
+			m_offPeriod = true;
+			m_nextTx = 0;
+			m_trainLength = 1;
+			m_trainSizes.clear ();
+			m_pacer.Reset (now);
+		}
+
+		/**
+		 * \brief Reset at now, draw the first arrival and schedule the first
+		 * packet.
+		 */
+		void Start (int64_t now)
+		{
+			Reset (now);
+			DrawArrival (now);
+			ScheduleNextTx ();
+		}
+
+		/**
+		 * \brief Draw the burst arrival that follows now and its length.
+		 */
+		void DrawArrival (int64_t now)
+		{
+			m_nextArrival = m_arrivals.Next (now);
+			m_nextLength = m_lengths.Next ();
+		}
+
+		/**
+		 * \brief Add an active burst without calling the sink, e.g. for a
+		 * stationary start or a restored state. Call Update once done.
+		 */
+		void AddBurst (int64_t end, int64_t length, uint32_t tag)
+		{
+			++m_active;
+			m_departures.push (Burst (end, length, tag));
+		}
+
+		/**
+		 * \brief Bring the pacer to the number of active bursts at now and
+		 * schedule the next train. In fluid mode no packet ever consumes the
+		 * credit, so none is accrued.
+		 */
+		void Update (int64_t now)
+		{
+			if (m_fluid)
+			{
+				m_pacer.Restore (now, m_active, 0);
+			}
+			else
+			{
+				m_pacer.SetActive (now, m_active);
+			}
+			ScheduleNextTx ();
+		}
+
+		/**
+		 * \brief Set the number of active bursts at now directly, for an
+		 * aggregate given as a rate process instead of as bursts; the engine
+		 * must then hold no burst and draw no arrival.
+		 */
+		void SetActive (int64_t now, uint32_t active)
+		{
+			m_active = active;
+			Update (now);
+		}
+
+		/**
+		 * \return the time step of the next event (arrival, departure or train).
+		 */
+		int64_t GetNextEvent () const
+		{
+			int64_t next = m_nextArrival;
+			if (!m_departures.empty () && m_departures.top ().end < next)
+			{
+				next = m_departures.top ().end;
+			}
+			if (!m_offPeriod && m_nextTx < next)
+			{
+				next = m_nextTx;
+			}
+			return next;
+		}
+
+		/**
+		 * \brief Handle the events due by now.
+		 */
+		void Process (int64_t now)
+		{
+			while (!m_departures.empty () && m_departures.top ().end <= now)
+			{
+				Burst burst = m_departures.top ();
+				m_departures.pop ();
+				--m_active;
+				m_sink.BurstEnd (now, burst.length, burst.tag);
+				Update (now);
+			}
+			if (m_nextArrival <= now)
+			{
+				++m_active;
+				uint32_t tag = m_sink.BurstStart (now, m_nextLength);
+				m_departures.push (Burst (m_nextArrival + m_nextLength, m_nextLength, tag));
+				DrawArrival (now);
+				Update (now);				// The pending train follows the new rate
+			}
+			if (!m_offPeriod && m_nextTx <= now)
+			{
+				SendTrain (now);
+			}
+		}
+
+		/**
+		 * \brief Handle every event before until.
+		 */
+		void Run (int64_t until)
+		{
+			int64_t next;
+			while ((next = GetNextEvent ()) < until)
+			{
+				Process (next);
+			}
+		}
+
+		uint32_t GetActive () const { return m_active; }
+		int64_t GetNextArrival () const { return m_nextArrival; }
+		int64_t GetNextLength () const { return m_nextLength; }
+		const Departures &GetDepartures () const { return m_departures; }
+		bool IsOffPeriod () const { return m_offPeriod; }
+		int64_t GetNextTx () const { return m_nextTx; }
+		uint32_t GetTrainLength () const { return m_trainLength; }
+
+		/**
+		 * \brief Size classes drawn for the pending train, empty when the
+		 * sizes are fixed.
+		 */
+		std::vector<uint32_t> &GetTrainSizes () { return m_trainSizes; }
+		const std::vector<uint32_t> &GetTrainSizes () const { return m_trainSizes; }
+
+		/**
+		 * \brief Set the next arrival and the pending train saved with the
+		 * getters above.
+		 */
+		void SetNextArrival (int64_t arrival, int64_t length)
+		{
+			m_nextArrival = arrival;
+			m_nextLength = length;
+		}
+		void SetTx (bool offPeriod, int64_t nextTx, uint32_t trainLength)
+		{
+			m_offPeriod = offPeriod;
+			m_nextTx = nextTx;
+			m_trainLength = trainLength;
+		}
+
+	private:
+		/**
+		 * \brief Schedule the next train. The departure time comes from
+		 * m_pacer and is recomputed whenever the number of active bursts
+		 * changes. Sizes are drawn once per packet and kept until the packet
+		 * is sent.
+		 */
+		void ScheduleNextTx ()
+		{
+			if (m_fluid || m_active == 0)
+			{
+				m_offPeriod = true;
+				return;
+			}
+			m_trainLength = 1;
+			if (m_trainMode)
+			{
+				m_trainLength = m_pacer.GetTrainLength (m_maxTrainJitter, m_maxTrainLength);
+			}
+			int64_t next;
+			if (m_sizes.IsFixed ())
+			{
+				next = m_pacer.GetNextTime (m_trainLength);
+			}
+			else
+			{
+				if (m_trainSizes.size () > m_trainLength)
+				{
+					m_trainSizes.resize (m_trainLength);
+				}
+				while (m_trainSizes.size () < m_trainLength)
+				{
+					m_trainSizes.push_back (m_sizes.Next ());
+				}
+				next = m_pacer.GetNextTimeBits (GetTrainBits ());
+			}
+			m_offPeriod = next < 0;
+			if (!m_offPeriod)
+			{
+				m_nextTx = next;
+			}
+		}
+
+		uint64_t GetTrainBits () const
+		{
+			uint64_t bits = 0;
+			for (uint32_t i = 0; i < m_trainSizes.size (); ++i)
+			{
+				bits += m_sizes.GetBits (m_trainSizes[i]);
+			}
+			return bits;
+		}
+
+		void SendTrain (int64_t now)
+		{
+			if (m_sizes.IsFixed ())
+			{
+				m_trainSizes.assign (m_trainLength, 0);
+				m_sink.Send (now, &m_trainSizes[0], m_trainLength);
+				m_pacer.Consume (now, m_trainLength);
+			}
+			else
+			{
+				m_sink.Send (now, &m_trainSizes[0], m_trainLength);
+				m_pacer.ConsumeBits (now, GetTrainBits ());
+			}
+			m_trainSizes.clear ();
+			ScheduleNextTx ();
+		}
+
+		Arrivals		m_arrivals;
+		Lengths			m_lengths;
+		Sizes			m_sizes;
+		Sink			m_sink;
+
+		bool			m_fluid;						// Send no packets
+		bool			m_trainMode;					// Send packets in back-to-back trains
+		int64_t			m_maxTrainJitter;				// Bound on the timing error within a train
+		uint32_t		m_maxTrainLength;				// Upper bound on the packets per train
+
+		int64_t			m_nextArrival;					// Time of the next burst arrival
+		int64_t			m_nextLength;					// Length of the burst arriving at m_nextArrival
+		Departures		m_departures;					// Active bursts by end time (min-heap)
+		uint32_t		m_active;						// Number of active bursts
+		PPBPPacer		m_pacer;						// Credit pacer of the packet departures
+		bool			m_offPeriod;					// No train pending
+		int64_t			m_nextTx;						// Time of the next train
+		uint32_t		m_trainLength;					// Packets in the pending train
+		std::vector<uint32_t>	m_trainSizes;			// Size classes of the pending train
+	};
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Draw a uniform in (0, 1] from a 64-bit generator such as
+	 *        std::mt19937_64.
+	 */
+	template <class Rng>
+	inline double
+	PPBPUniform (Rng &rng)
+	{
+		return ((rng () >> 11) + 1) * (1.0 / 9007199254740992.0);
+	}
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Arrivals policy: Poisson burst arrivals at a constant rate.
+	 */
+	template <class Rng>
+	class PPBPPoissonArrivals
+	{
+	public:
+		PPBPPoissonArrivals () : m_rng (0), m_meanSteps (1) {}
+
+		/**
+		 * \param rng generator, which must outlive the policy
+		 * \param rate mean rate of burst arrivals (1/s)
+		 * \param stepsPerSecond time steps per second
+		 */
+		PPBPPoissonArrivals (Rng *rng, double rate, int64_t stepsPerSecond)
+			: m_rng (rng), m_meanSteps (stepsPerSecond / rate) {}
+
+		int64_t Next (int64_t now)
+		{
+			return now + (int64_t) (-std::log (PPBPUniform (*m_rng)) * m_meanSteps);
+		}
+
+	private:
+		Rng			*m_rng;
+		double		m_meanSteps;						// Mean interval in time steps
+	};
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Lengths policy: Pareto burst lengths of shape 3 - 2H and the
+	 *        given mean.
+	 */
+	template <class Rng>
+	class PPBPParetoLengths
+	{
+	public:
+		PPBPParetoLengths () : m_rng (0), m_scaleSteps (1), m_exponent (-1) {}
+
+		/**
+		 * \param rng generator, which must outlive the policy
+		 * \param mean mean burst length (s)
+		 * \param h Hurst parameter, in (0.5, 1)
+		 * \param stepsPerSecond time steps per second
+		 */
+		PPBPParetoLengths (Rng *rng, double mean, double h, int64_t stepsPerSecond)
+			: m_rng (rng)
+		{
+			double shape = 3 - 2 * h;
+			m_scaleSteps = (shape - 1) * mean / shape * stepsPerSecond;
+			m_exponent = -1 / shape;
+		}
+
+		int64_t Next ()
+		{
+			return (int64_t) (m_scaleSteps * std::pow (PPBPUniform (*m_rng), m_exponent));
+		}
+
+	private:
+		Rng			*m_rng;
+		double		m_scaleSteps;						// Pareto scale in time steps
+		double		m_exponent;							// -1 / shape
+	};
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Sizes policy: every packet is of the size the pacer was set up
+	 *        with.
+	 */
+	class PPBPFixedSize
+	{
+	public:
+		PPBPFixedSize () : m_bits (0) {}
+		PPBPFixedSize (uint64_t bits) : m_bits (bits) {}
+
+		bool IsFixed () const { return true; }
+		uint32_t Next () { return 0; }
+		uint64_t GetBits (uint32_t sizeClass) const { return m_bits; }
+
+	private:
+		uint64_t	m_bits;								// Bits charged per packet
+	};
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Sink policy that only counts bursts and packets.
+	 */
+	class PPBPCountingSink
+	{
+	public:
+		PPBPCountingSink () : m_bursts (0), m_packets (0) {}
+
+		uint32_t BurstStart (int64_t now, int64_t length) { ++m_bursts; return 0; }
+		void BurstEnd (int64_t now, int64_t length, uint32_t tag) {}
+		void Send (int64_t now, const uint32_t *sizeClasses, uint32_t packets) { m_packets += packets; }
+
+		uint64_t GetBursts () const { return m_bursts; }
+		uint64_t GetPackets () const { return m_packets; }
+
+	private:
+		uint64_t	m_bursts;							// Bursts started
+		uint64_t	m_packets;							// Packets sent
+	};
+
+} // namespace ns3
+#endif
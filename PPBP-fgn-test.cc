@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This script checks the fractional Gaussian noise of PPBPFgnGenerator,
+*  used by PPBPApplication when FgnSlot is set. For every H of the list it
+*  generates the given number of paths of pathLength samples and checks:
+*  - the variance, which must be 1 within the given number of standard
+*    errors (computed from the autocovariance, as the samples are correlated);
+*  - the lag-1 autocorrelation, which must be 2^(2H-1) - 1;
+*  - the aggregated-variance and wavelet estimates of H made by
+*    PPBPHurstEstimator on each path, averaged over the paths.
+*  Each path is estimated on its own, since the correlations are cut
+*  between paths. The program fails if any check is out of tolerance.
+*  Example run: Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-fgn-test --H=0.55,0.7,0.9 --paths=32"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "PPBP-check.h"
+#include <cmath>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPFgnTest");
+
+// Autocovariance of unit-variance fGn
+static double
+GetAutocovariance (double h, double k)
+{
+  return (std::pow (k + 1, 2 * h) - 2 * std::pow (k, 2 * h) + std::pow (std::fabs (k - 1), 2 * h)) / 2;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string hurstList = "0.55,0.7,0.9";
+  uint32_t pathLength = 65536;
+  uint32_t paths = 32;
+  double sigmas = 5;
+  double tolerance = 0.03;
+  double hurstTolerance = 0.05;
+
+  CommandLine cmd;
+  cmd.AddValue ("H", "Hurst parameters to check", hurstList);
+  cmd.AddValue ("pathLength", "Samples per path (rounded up to a power of two)", pathLength);
+  cmd.AddValue ("paths", "Paths per Hurst parameter (rounded up to an even number)", paths);
+  cmd.AddValue ("sigmas", "Tolerance of the variance in standard errors", sigmas);
+  cmd.AddValue ("tolerance", "Tolerance of the lag-1 autocorrelation", tolerance);
+  cmd.AddValue ("hurstTolerance", "Tolerance of the estimates of H", hurstTolerance);
+  cmd.Parse (argc, argv);
+
+  Time::SetResolution (Time::NS);
+
+  Ptr<NormalRandomVariable> normal = CreateObject<NormalRandomVariable> ();
+  normal->SetAttribute ("Mean", DoubleValue (0));
+  normal->SetAttribute ("Variance", DoubleValue (1));
+  normal->SetStream (0);
+
+  std::istringstream list (hurstList);
+  std::string item;
+  while (std::getline (list, item, ','))
+    {
+      double h = std::atof (item.c_str ());
+      PPBPFgnGenerator fgn;
+      fgn.Set (h, pathLength);
+      uint32_t n = fgn.GetPathLength ();
+      NS_LOG_UNCOND ("H=" << h << ", " << paths << " paths of " << n << " samples");
+
+      std::vector<double> normals (fgn.GetNormalsPerBlock ());
+      std::vector<double> samples;
+      double square = 0;
+      double lag1 = 0;
+      double aggregated = 0;
+      double wavelet = 0;
+      uint32_t done = 0;
+      while (done < paths)
+        {
+          for (uint32_t i = 0; i < normals.size (); ++i)
+            {
+              normals[i] = normal->GetValue ();
+            }
+          fgn.Generate (&normals[0], samples);
+          // The block holds two independent paths, one after the other
+          for (uint32_t p = 0; p < 2; ++p, ++done)
+            {
+              const double *x = &samples[p * n];
+              Ptr<PPBPHurstEstimator> estimator = CreateObject<PPBPHurstEstimator> ();
+              estimator->SetAttribute ("BinWidth", TimeValue (MilliSeconds (1)));
+              estimator->SetAttribute ("MinOctave", UintegerValue (1));
+              // Only the scales with many samples, which the removal of the
+              // path mean biases the least
+              estimator->SetAttribute ("MinSamples", UintegerValue (256));
+              for (uint32_t i = 0; i < n; ++i)
+                {
+                  // The mean is known to be zero; an affine map keeps H
+                  square += x[i] * x[i];
+                  if (i + 1 < n)
+                    {
+                      lag1 += x[i] * x[i + 1];
+                    }
+                  estimator->Add (MilliSeconds (i), (uint32_t) std::floor (1e6 + 1e4 * x[i] + 0.5));
+                }
+              estimator->Advance (MilliSeconds (n));
+              aggregated += estimator->GetHurstAggregatedVariance ();
+              wavelet += estimator->GetHurstWavelet ();
+            }
+        }
+
+      // Var (mean of x^2) over a path = 2/N sum_|k|<N (1 - |k|/N) gamma(k)^2
+      double error = 1;
+      for (uint32_t k = 1; k < n; ++k)
+        {
+          double gamma = GetAutocovariance (h, k);
+          error += 2 * (1 - (double) k / n) * gamma * gamma;
+        }
+      error = std::sqrt (2 * error / n / done);
+      double variance = square / ((double) done * n);
+      PPBPCheck ("variance", variance, 1, sigmas * error);
+      PPBPCheck ("lag-1 autocorrelation", lag1 / ((double) done * (n - 1)) / variance, GetAutocovariance (h, 1), tolerance);
+      PPBPCheck ("H (aggregated variance)", aggregated / done, h, hurstTolerance);
+      PPBPCheck ("H (wavelet)", wavelet / done, h, hurstTolerance);
+    }
+
+  return PPBPCheckSummary ();
+}
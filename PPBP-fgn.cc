@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-fgn.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPFgnGenerator");
+
+namespace ns3 {
+
+	PPBPFgnGenerator::PPBPFgnGenerator ()
+		: m_h (0),
+		  m_n (0)
+	{
+	}
+
+	void
+	PPBPFgnGenerator::Set (double h, uint32_t pathLength)
+	{
+		NS_ABORT_MSG_IF (h <= 0 || h >= 1, "fGn needs 0 < H < 1");
+		NS_ABORT_MSG_IF (pathLength == 0 || pathLength > (1u << 30), "Bad fGn path length " << pathLength);
+		m_h = h;
+		m_n = 1;
+		while (m_n < pathLength)
+		{
+			m_n *= 2;
+		}
+		uint32_t size = 2 * m_n;
+
+		m_twiddles.resize (m_n);
+		for (uint32_t k = 0; k < m_n; ++k)
+		{
+			m_twiddles[k] = std::polar (1.0, -M_PI * k / m_n);
+		}
+
+		// First row of the circulant: gamma(0..N), then gamma(N-1..1)
+		m_work.assign (size, 0);
+		for (uint32_t k = 0; k <= m_n; ++k)
+		{
+			double gamma = 0.5 * (std::pow (k + 1.0, 2 * h) - 2 * std::pow ((double) k, 2 * h)
+								  + std::pow (std::fabs (k - 1.0), 2 * h));
+			m_work[k] = gamma;
+			if (k > 0 && k < m_n)
+			{
+				m_work[size - k] = gamma;
+			}
+		}
+		Fft (m_work);
+
+		m_scale.resize (size);
+		double smallest = 0;
+		for (uint32_t k = 0; k < size; ++k)
+		{
+			// Real and non-negative up to rounding
+			double lambda = m_work[k].real ();
+			smallest = std::min (smallest, lambda);
+			m_scale[k] = std::sqrt (std::max (0.0, lambda) / size);
+		}
+		NS_LOG_INFO ("fGn embedding of size " << size << " for H " << h << ", smallest eigenvalue " << smallest);
+	}
+
+	double
+	PPBPFgnGenerator::GetHurst () const
+	{
+		return m_h;
+	}
+
+	uint32_t
+	PPBPFgnGenerator::GetPathLength () const
+	{
+		return m_n;
+	}
+
+	uint32_t
+	PPBPFgnGenerator::GetNormalsPerBlock () const
+	{
+		return 4 * m_n;
+	}
+
+	void
+	PPBPFgnGenerator::Generate (const double *normals, std::vector<double> &samples)
+	{
+		NS_ABORT_MSG_IF (m_n == 0, "PPBPFgnGenerator used before Set");
+		uint32_t size = 2 * m_n;
+		m_work.resize (size);
+		for (uint32_t k = 0; k < size; ++k)
+		{
+			m_work[k] = std::complex<double> (m_scale[k] * normals[2 * k], m_scale[k] * normals[2 * k + 1]);
+		}
+		Fft (m_work);
+		samples.resize (size);
+		for (uint32_t k = 0; k < m_n; ++k)
+		{
+			samples[k] = m_work[k].real ();
+			samples[m_n + k] = m_work[k].imag ();
+		}
+	}
+
+	void
+	PPBPFgnGenerator::Fft (std::vector<std::complex<double> > &x) const
+	{
+		// Iterative radix-2, in place; the size is 2N
+		uint32_t size = x.size ();
+		for (uint32_t i = 1, j = 0; i < size; ++i)
+		{
+			uint32_t bit = size >> 1;
+			for (; j & bit; bit >>= 1)
+			{
+				j ^= bit;
+			}
+			j ^= bit;
+			if (i < j)
+			{
+				std::swap (x[i], x[j]);
+			}
+		}
+		for (uint32_t len = 2; len <= size; len <<= 1)
+		{
+			uint32_t half = len / 2;
+			uint32_t stride = size / len;
+			for (uint32_t i = 0; i < size; i += len)
+			{
+				for (uint32_t k = 0; k < half; ++k)
+				{
+					std::complex<double> t = m_twiddles[k * stride] * x[i + k + half];
+					x[i + k + half] = x[i + k] - t;
+					x[i + k] += t;
+				}
+			}
+		}
+	}
+
+} // namespace ns3
@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_fgn_h__
+#define __PPBP_fgn_h__
+
+#include <stdint.h>
+#include <complex>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Fractional Gaussian noise generated in blocks by circulant
+	 *        embedding (Davies-Harte).
+	 *
+	 * The autocovariance of unit-variance fGn,
+	 * gamma(k) = (|k+1|^2H - 2|k|^2H + |k-1|^2H) / 2, is embedded in a
+	 * circulant matrix of size 2N whose eigenvalues, non-negative for
+	 * 0 < H < 1, are computed once by FFT when the generator is set. A block
+	 * then costs one FFT of size 2N on 4N standard normals, and the real and
+	 * imaginary parts of its first N points are two independent exact fGn
+	 * paths of length N (Dietrich and Newsam), returned one after the other.
+	 * The correlations are therefore exact within a path of N samples and
+	 * cut between paths.
+	 */
+	class PPBPFgnGenerator
+	{
+	public:
+		PPBPFgnGenerator ();
+
+		/**
+		 * \brief Set the Hurst parameter and the path length N, rounded up to
+		 * a power of two, and compute the eigenvalues of the embedding.
+		 */
+		void Set (double h, uint32_t pathLength);
+
+		double GetHurst () const;
+
+		/**
+		 * \return the path length N.
+		 */
+		uint32_t GetPathLength () const;
+
+		/**
+		 * \return the number of normals a block needs, 4N.
+		 */
+		uint32_t GetNormalsPerBlock () const;
+
+		/**
+		 * \brief Generate a block of 2N fGn samples of unit variance.
+		 *
+		 * \param normals GetNormalsPerBlock () independent standard normals
+		 * \param samples resized to 2N and filled
+		 */
+		void Generate (const double *normals, std::vector<double> &samples);
+
+	private:
+		void Fft (std::vector<std::complex<double> > &x) const;
+
+		double			m_h;							// Hurst parameter
+		uint32_t		m_n;							// Path length N
+		std::vector<double>		m_scale;				// sqrt (eigenvalue / 2N), per frequency
+		std::vector<std::complex<double> >	m_twiddles;	// exp (-2 pi i k / 2N), k < N
+		std::vector<std::complex<double> >	m_work;		// FFT buffer of size 2N
+	};
+
+} // namespace ns3
+#endif
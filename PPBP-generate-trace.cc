@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This program runs the PPBP process offline, without any topology, and
+*  writes the packet departures to a PPBP trace file that can be replayed
+*  with PPBPTracePlayerApplication. Independent sources are generated on a
+*  pool of threads and merged into one time-ordered trace; the output does
+*  not depend on the number of threads. threads may be a comma-separated
+*  list: the trace is then generated once per thread count, with the wall
+*  time of each, and the program fails if the packet counts differ.
+*  With pcapng set, the trace is also written as a pcapng capture of
+*  synthetic Ethernet/IPv4/UDP frames (one source address per source) for
+*  external replay tools; snapLength bounds the bytes captured per frame.
+*  Example run: Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-generate-trace --duration=60 --sources=1000 --output=ppbp.trace"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include <chrono>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPGenerateTrace");
+
+template <typename T>
+static std::vector<T>
+SplitList (std::string list)
+{
+  std::vector<T> values;
+  std::istringstream in (list);
+  std::string item;
+  while (std::getline (in, item, ','))
+    {
+      std::istringstream value (item);
+      T v;
+      value >> v;
+      values.push_back (v);
+    }
+  return values;
+}
+
+int
+main (int argc, char *argv[])
+{
+  double duration = 10; //seconds
+  std::string output = "ppbp.trace";
+  double hurst = 0.7;
+  double burstArrivals = 20.0;
+  double burstLength = 0.2;
+  std::string burstIntensity = "1Mb/s";
+  uint32_t packetSize = 1470;
+  int64_t stream = 0;
+  uint32_t sources = 1;
+  std::string threadsList = "0";
+  std::string pcapng = "";
+  uint32_t snapLength = 65535;
+
+  CommandLine cmd;
+  cmd.AddValue ("duration", "Generated time span (s)", duration);
+  cmd.AddValue ("output", "Trace file to write", output);
+  cmd.AddValue ("H", "Hurst parameter", hurst);
+  cmd.AddValue ("burstArrivals", "Mean rate of burst arrivals (1/s)", burstArrivals);
+  cmd.AddValue ("burstLength", "Mean burst time length (s)", burstLength);
+  cmd.AddValue ("burstIntensity", "Data rate of each burst", burstIntensity);
+  cmd.AddValue ("packetSize", "Packet size (bytes)", packetSize);
+  cmd.AddValue ("stream", "First random variable stream", stream);
+  cmd.AddValue ("sources", "Number of independent sources", sources);
+  cmd.AddValue ("threads", "Worker threads (0 for one per core), or a list of them to compare", threadsList);
+  cmd.AddValue ("pcapng", "Also write the packets to this pcapng file", pcapng);
+  cmd.AddValue ("snapLength", "Bytes captured per frame in the pcapng file", snapLength);
+  cmd.Parse (argc, argv);
+
+  Time::SetResolution (Time::NS);
+
+  PPBPParallelTraceGenerator generator;
+  generator.SetAttribute ("H", DoubleValue (hurst));
+  generator.SetAttribute ("BurstIntensity", DataRateValue (DataRate (burstIntensity)));
+  generator.SetAttribute ("PacketSize", UintegerValue (packetSize));
+  std::ostringstream arrivals;
+  arrivals << "ns3::ConstantRandomVariable[Constant=" << burstArrivals << "]";
+  generator.SetAttribute ("MeanBurstArrivals", StringValue (arrivals.str ()));
+  std::ostringstream length;
+  length << "ns3::ConstantRandomVariable[Constant=" << burstLength << "]";
+  generator.SetAttribute ("MeanBurstTimeLength", StringValue (length.str ()));
+
+  std::vector<uint32_t> threads = SplitList<uint32_t> (threadsList);
+  uint64_t packets = 0;
+  for (uint32_t i = 0; i < threads.size (); ++i)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      uint64_t written = generator.Generate (sources, Seconds (duration), stream, threads[i], output);
+      double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+      NS_LOG_UNCOND ("Wrote " << written << " packets to " << output << " with threads=" << threads[i]
+                     << " in " << wall << " s");
+      if (i > 0 && written != packets)
+        {
+          NS_LOG_UNCOND ("The packet count depends on the number of threads");
+          return 1;
+        }
+      packets = written;
+    }
+
+  if (!pcapng.empty ())
+    {
+      packets = PPBPPcapngWriter::Convert (output, pcapng, snapLength);
+      NS_LOG_UNCOND ("Wrote " << packets << " packets to " << pcapng);
+    }
+  return 0;
+}
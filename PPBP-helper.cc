@@ -19,10 +19,15 @@
  */
 
 #include "PPBP-helper.h"
+#include "ns3/PPBP-application.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/packet-socket-address.h"
 #include "ns3/string.h"
 #include "ns3/names.h"
+#include <algorithm>
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
 
 namespace ns3 {
 
@@ -42,6 +47,10 @@ PPBPHelper::SetAttribute (std::string name, const AttributeValue &value)
 ApplicationContainer
 PPBPHelper::Install (Ptr<Node> node) const
 {
+  if (!IsLocal (node))
+    {
+      return ApplicationContainer ();
+    }
   return ApplicationContainer (InstallPriv (node));
 }
 
@@ -49,7 +58,7 @@ ApplicationContainer
 PPBPHelper::Install (std::string nodeName) const
 {
   Ptr<Node> node = Names::Find<Node> (nodeName);
-  return ApplicationContainer (InstallPriv (node));
+  return Install (node);
 }
 
 ApplicationContainer
@@ -58,16 +67,70 @@ PPBPHelper::Install (NodeContainer c) const
   ApplicationContainer apps;
   for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
-      apps.Add (InstallPriv (*i));
+      if (IsLocal (*i))
+        {
+          apps.Add (InstallPriv (*i));
+        }
     }
 
   return apps;
 }
 
+void
+PPBPHelper::AddRemote (Address address)
+{
+  m_remotes.push_back (address);
+}
+
+int64_t
+PPBPHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  // Numbered by global position, so that it does not depend on the rank
+  // that owns the node
+  const int64_t perApplication = 5;
+  int64_t n = c.GetN ();
+  uint32_t layers = 1;
+  Ptr<Node> node;
+  int64_t index = 0;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i, ++index)
+    {
+      node = (*i);
+      uint32_t k = 0;
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          Ptr<PPBPApplication> ppbp = DynamicCast<PPBPApplication> (node->GetApplication (j));
+          if (ppbp)
+            {
+              ppbp->AssignStreams (stream + (k * n + index) * perApplication);
+              ++k;
+            }
+        }
+      layers = std::max (layers, k);
+    }
+  return layers * n * perApplication;
+}
+
+bool
+PPBPHelper::IsLocal (Ptr<Node> node) const
+{
+#ifdef NS3_MPI
+  if (MpiInterface::IsEnabled ())
+    {
+      return node->GetSystemId () == MpiInterface::GetSystemId ();
+    }
+#endif
+  return true;
+}
+
 Ptr<Application>
 PPBPHelper::InstallPriv (Ptr<Node> node) const
 {
   Ptr<Application> app = m_factory.Create<Application> ();
+  Ptr<PPBPApplication> ppbp = DynamicCast<PPBPApplication> (app);
+  for (uint32_t i = 0; ppbp && i < m_remotes.size (); ++i)
+    {
+      ppbp->AddRemote (m_remotes[i]);
+    }
   node->AddApplication (app);
 
   return app;
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include "ns3/object-factory.h"
 #include "ns3/address.h"
 #include "ns3/attribute.h"
@@ -35,6 +36,12 @@ namespace ns3 {
 /**
  * \brief A helper to make it easier to instantiate an ns3::Application
  * on a set of nodes.
+ *
+ * In a distributed (MPI) simulation every rank builds the whole topology
+ * and calls the helper on the same nodes; applications are only installed
+ * on the nodes whose system id is the local rank, and AssignStreams numbers
+ * the streams by the position of the node in the container, so a source
+ * draws the same values whatever the number of ranks.
  */
 class PPBPHelper
 {
@@ -59,9 +66,18 @@ public:
    */
   void SetAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * Add a destination for the bursts of the applications installed from
+   * now on (see PPBPApplication::AddRemote and the FlowPerBurst attribute).
+   *
+   * \param address the address of a remote node to send bursts to
+   */
+  void AddRemote (Address address);
+
   /**
    * Install an ns3::Application on each node of the input container
-   * configured with all the attributes set with SetAttribute.
+   * configured with all the attributes set with SetAttribute. With MPI
+   * enabled, nodes owned by other ranks are skipped.
    *
    * \param c NodeContainer of the set of nodes on which an Application
    * will be installed.
@@ -87,6 +103,27 @@ public:
    */
   ApplicationContainer Install (std::string nodeName) const;
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.  The Install() method should have previously been
+   * called by the user.
+   *
+   * The k-th PPBPApplication of the node at position i of the container
+   * gets the streams from stream + (k x N + i) x 5, N being the size of the
+   * container, so the numbering only depends on the global position of the
+   * source and not on which rank owns it. The count returned covers as many
+   * applications per node as the busiest local node has; with MPI, give
+   * every node of the container the same number of PPBP applications so
+   * that all ranks agree on it.
+   *
+   * \param stream first stream index to use
+   * \param c NodeContainer of the set of nodes for which the PPBPApplication
+   *          should be modified to use a fixed stream
+   * \return the number of stream indices assigned by this helper
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
+
 private:
   /**
    * \internal
@@ -97,8 +134,15 @@ private:
    * \returns Ptr to the application installed.
    */
   Ptr<Application> InstallPriv (Ptr<Node> node) const;
+
+  /**
+   * \internal
+   * \returns true unless MPI is enabled and the node belongs to another rank.
+   */
+  bool IsLocal (Ptr<Node> node) const;
   std::string m_protocol;
   Address m_remote;
+  std::vector<Address> m_remotes;
   ObjectFactory m_factory;
 };
 
@@ -0,0 +1,312 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-hurst-estimator.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPHurstEstimator");
+
+namespace ns3 {
+
+	NS_OBJECT_ENSURE_REGISTERED (PPBPHurstEstimator);
+
+	namespace {
+
+		double
+		Digamma (double x)
+		{
+			double r = 0;
+			while (x < 6)
+			{
+				r -= 1 / x;
+				x += 1;
+			}
+			double x2 = 1 / (x * x);
+			return r + std::log (x) - 0.5 / x - x2 * (1.0 / 12 - x2 * (1.0 / 120 - x2 / 252));
+		}
+
+		double
+		Trigamma (double x)
+		{
+			double r = 0;
+			while (x < 6)
+			{
+				r += 1 / (x * x);
+				x += 1;
+			}
+			double x2 = 1 / (x * x);
+			return r + 1 / x + x2 / 2 + x2 / x * (1.0 / 6 - x2 * (1.0 / 30 - x2 / 42));
+		}
+
+		// Weighted least-squares slope of y over x
+		double
+		Slope (const std::vector<double> &x, const std::vector<double> &y, const std::vector<double> &w)
+		{
+			double sw = 0, sx = 0, sy = 0;
+			for (uint32_t i = 0; i < x.size (); ++i)
+			{
+				sw += w[i];
+				sx += w[i] * x[i];
+				sy += w[i] * y[i];
+			}
+			double mx = sx / sw;
+			double my = sy / sw;
+			double sxx = 0, sxy = 0;
+			for (uint32_t i = 0; i < x.size (); ++i)
+			{
+				sxx += w[i] * (x[i] - mx) * (x[i] - mx);
+				sxy += w[i] * (x[i] - mx) * (y[i] - my);
+			}
+			return sxy / sxx;
+		}
+
+	} // anonymous namespace
+
+	TypeId
+	PPBPHurstEstimator::GetTypeId (void)
+	{
+		static TypeId tid = TypeId ("ns3::PPBPHurstEstimator")
+		.SetParent<Object> ()
+		.AddConstructor<PPBPHurstEstimator> ()
+		.AddAttribute ("BinWidth", "Finest time scale over which bytes are counted.",
+					   TimeValue (MilliSeconds (10)),
+					   MakeTimeAccessor (&PPBPHurstEstimator::m_binWidth),
+					   MakeTimeChecker ())
+		.AddAttribute ("MinOctave", "First dyadic time scale (2^MinOctave x BinWidth) used to estimate H; "
+					   "it should lie above the mean burst length, where the scaling begins.",
+					   UintegerValue (6),
+					   MakeUintegerAccessor (&PPBPHurstEstimator::m_minOctave),
+					   MakeUintegerChecker<uint32_t> ())
+		.AddAttribute ("MinSamples", "Samples a time scale needs to be used to estimate H.",
+					   UintegerValue (16),
+					   MakeUintegerAccessor (&PPBPHurstEstimator::m_minSamples),
+					   MakeUintegerChecker<uint32_t> (2))
+		;
+		return tid;
+	}
+
+	PPBPHurstEstimator::PPBPHurstEstimator ()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		m_binWidth = MilliSeconds (10);
+		m_minOctave = 6;
+		m_minSamples = 16;
+		m_started = false;
+		m_bin = 0;
+		m_binBytes = 0;
+		m_binPackets = 0;
+	}
+
+	PPBPHurstEstimator::~PPBPHurstEstimator()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+	}
+
+	void
+	PPBPHurstEstimator::NotifyTx (Ptr<const Packet> packet)
+	{
+		Add (Simulator::Now (), packet->GetSize ());
+	}
+
+	void
+	PPBPHurstEstimator::Add (Time time, uint32_t bytes)
+	{
+		if (!m_started)
+		{
+			m_started = true;
+			m_start = time;
+		}
+		Advance (time);
+		m_binBytes += bytes;
+		m_binPackets += 1;
+	}
+
+	void
+	PPBPHurstEstimator::Advance (Time time)
+	{
+		if (!m_started)
+		{
+			return;
+		}
+		int64_t bin = (time - m_start).GetTimeStep () / m_binWidth.GetTimeStep ();
+		while (m_bin < bin)
+		{
+			Close (m_binBytes, m_binPackets);
+			m_binBytes = 0;
+			m_binPackets = 0;
+			++m_bin;
+		}
+	}
+
+	void
+	PPBPHurstEstimator::Close (double bytes, double packets)
+	{
+		// Carry the closed bin up the levels like a binary counter
+		double detail = 0;
+		for (uint32_t j = 0; ; ++j)
+		{
+			if (j == m_levels.size ())
+			{
+				Level l = Level ();
+				m_levels.push_back (l);
+			}
+			Level &l = m_levels[j];
+
+			l.n++;
+			double delta = bytes - l.mean;
+			l.mean += delta / l.n;
+			l.m2 += delta * (bytes - l.mean);
+			double packetDelta = packets - l.packetMean;
+			l.packetMean += packetDelta / l.n;
+			l.packetM2 += packetDelta * (packets - l.packetMean);
+			if (j > 0)
+			{
+				l.details++;
+				l.energy += detail * detail;
+			}
+
+			if (!l.pending)
+			{
+				l.pending = true;
+				l.pendingBytes = bytes;
+				l.pendingPackets = packets;
+				return;
+			}
+			l.pending = false;
+			// Haar detail of octave j+1 on counts normalized by 2^((j+1)/2)
+			detail = (l.pendingBytes - bytes) / std::sqrt (std::ldexp (1.0, j + 1));
+			bytes += l.pendingBytes;
+			packets += l.pendingPackets;
+		}
+	}
+
+	bool
+	PPBPHurstEstimator::IsFitted (uint32_t level) const
+	{
+		return level >= m_minOctave && level < m_levels.size () && m_levels[level].n >= m_minSamples;
+	}
+
+	uint32_t
+	PPBPHurstEstimator::GetNLevels () const
+	{
+		return m_levels.size ();
+	}
+
+	uint64_t
+	PPBPHurstEstimator::GetNSamples (uint32_t level) const
+	{
+		return level < m_levels.size () ? m_levels[level].n : 0;
+	}
+
+	double
+	PPBPHurstEstimator::GetVariance (uint32_t level) const
+	{
+		if (level >= m_levels.size () || m_levels[level].n < 2)
+		{
+			return 0;
+		}
+		return m_levels[level].m2 / (m_levels[level].n - 1);
+	}
+
+	double
+	PPBPHurstEstimator::GetIndexOfDispersion (uint32_t level) const
+	{
+		if (level >= m_levels.size () || m_levels[level].n < 2 || m_levels[level].packetMean == 0)
+		{
+			return 0;
+		}
+		const Level &l = m_levels[level];
+		return l.packetM2 / (l.n - 1) / l.packetMean;
+	}
+
+	double
+	PPBPHurstEstimator::GetMeanRate () const
+	{
+		if (m_levels.empty ())
+		{
+			return 0;
+		}
+		return m_levels[0].mean * 8 / m_binWidth.GetSeconds ();
+	}
+
+	double
+	PPBPHurstEstimator::GetHurstAggregatedVariance () const
+	{
+		std::vector<double> x, y, w;
+		for (uint32_t j = m_minOctave; IsFitted (j); ++j)
+		{
+			double v = GetVariance (j);
+			if (v <= 0)
+			{
+				continue;
+			}
+			// Variance of the mean rate over 2^j bins
+			x.push_back (j);
+			y.push_back (std::log2 (v) - 2.0 * j);
+			w.push_back (1);
+		}
+		if (x.size () < 2)
+		{
+			return std::numeric_limits<double>::quiet_NaN ();
+		}
+		return 1 + Slope (x, y, w) / 2;
+	}
+
+	double
+	PPBPHurstEstimator::GetHurstWavelet () const
+	{
+		std::vector<double> x, y, w;
+		for (uint32_t j = std::max<uint32_t> (m_minOctave, 1); IsFitted (j); ++j)
+		{
+			const Level &l = m_levels[j];
+			if (l.details < m_minSamples || l.energy <= 0)
+			{
+				break;
+			}
+			double half = l.details / 2.0;
+			double mu = l.energy / l.details;
+			x.push_back (j);
+			y.push_back (std::log2 (mu) - (Digamma (half) / M_LN2 - std::log2 (half)));
+			w.push_back (M_LN2 * M_LN2 / Trigamma (half));
+		}
+		if (x.size () < 2)
+		{
+			return std::numeric_limits<double>::quiet_NaN ();
+		}
+		return (Slope (x, y, w) + 1) / 2;
+	}
+
+	void
+	PPBPHurstEstimator::Print (std::ostream &os) const
+	{
+		os << "Mean rate " << GetMeanRate () << " bit/s, H (aggregated variance) "
+		   << GetHurstAggregatedVariance () << ", H (wavelet) " << GetHurstWavelet () << std::endl;
+		os << "level\tscale(s)\tsamples\tvariance\tIDC\tdetail energy" << std::endl;
+		for (uint32_t j = 0; j < m_levels.size (); ++j)
+		{
+			const Level &l = m_levels[j];
+			os << j << "\t" << std::ldexp (m_binWidth.GetSeconds (), j) << "\t" << l.n << "\t"
+			   << GetVariance (j) << "\t" << GetIndexOfDispersion (j) << "\t"
+			   << (l.details ? l.energy / l.details : 0) << std::endl;
+		}
+	}
+
+} // namespace ns3
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_hurst_estimator_h__
+#define __PPBP_hurst_estimator_h__
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Streaming estimator of the Hurst parameter and rate statistics
+	 *        of a packet stream.
+	 *
+	 * Connect NotifyTx to the "Tx" trace source of a PPBPApplication (or feed
+	 * Add with the records of a trace). Bytes and packets are counted in bins
+	 * of BinWidth, and each closed bin is folded into a binary counter of
+	 * dyadic time scales: level j holds the running mean and variance of the
+	 * counts over 2^j bins, and the energy of the Haar details between pairs
+	 * of level j-1 counts. Only one pending count per level is kept, so the
+	 * memory grows with log2 of the number of bins.
+	 *
+	 * Two estimates of H are available at any time from the closed bins:
+	 * - aggregated variance: Var(X^(m)) ~ m^(2H-2), fitted by least squares
+	 *   on log2 Var over the levels;
+	 * - wavelet (Abry-Veitch): the mean Haar detail energy of octave j grows
+	 *   as 2^(j(2H-1)); the log2 energies, corrected for their bias, are
+	 *   fitted by weighted least squares with their inverse variances.
+	 *
+	 * Both fits use the levels from MinOctave up to the last one with at
+	 * least MinSamples values.
+	 */
+	class PPBPHurstEstimator : public Object
+	{
+	public:
+		static TypeId GetTypeId (void);
+
+		PPBPHurstEstimator ();
+
+		virtual ~PPBPHurstEstimator();
+
+		/**
+		 * \brief Count a packet sent now. Matches the signature of the
+		 * "Tx" trace source.
+		 */
+		void          NotifyTx (Ptr<const Packet> packet);
+
+		/**
+		 * \brief Count bytes sent at the given time. Times must not decrease.
+		 */
+		void          Add (Time time, uint32_t bytes);
+
+		/**
+		 * \brief Close the bins that end before the given time, so that an
+		 * idle period is accounted for.
+		 */
+		void          Advance (Time time);
+
+		/**
+		 * \return the number of time scales reached so far.
+		 */
+		uint32_t      GetNLevels () const;
+
+		/**
+		 * \return the number of closed bins of 2^level BinWidth.
+		 */
+		uint64_t      GetNSamples (uint32_t level) const;
+
+		/**
+		 * \return the variance of the bytes per bin of 2^level BinWidth.
+		 */
+		double        GetVariance (uint32_t level) const;
+
+		/**
+		 * \return the index of dispersion Var/E of the packet counts per bin
+		 * of 2^level BinWidth.
+		 */
+		double        GetIndexOfDispersion (uint32_t level) const;
+
+		/**
+		 * \return the mean rate of the closed bins (bit/s).
+		 */
+		double        GetMeanRate () const;
+
+		/**
+		 * \return the aggregated-variance estimate of H, or NaN while fewer
+		 * than two levels can be fitted.
+		 */
+		double        GetHurstAggregatedVariance () const;
+
+		/**
+		 * \return the wavelet estimate of H, or NaN while fewer than two
+		 * octaves can be fitted.
+		 */
+		double        GetHurstWavelet () const;
+
+		/**
+		 * \brief Print the estimates and the statistics of every level.
+		 */
+		void          Print (std::ostream &os) const;
+
+	private:
+		struct Level
+		{
+			bool		pending;						// A count waits for its pair
+			double		pendingBytes;
+			double		pendingPackets;
+			uint64_t	n;								// Counts seen at this level
+			double		mean;							// Running mean of the bytes
+			double		m2;								// Sum of squared deviations of the bytes
+			double		packetMean;						// Running mean of the packets
+			double		packetM2;						// Sum of squared deviations of the packets
+			uint64_t	details;						// Haar details of this octave
+			double		energy;							// Sum of their squares
+		};
+
+		void Close (double bytes, double packets);
+		bool IsFitted (uint32_t level) const;
+
+		Time			m_binWidth;						// Finest time scale
+		uint32_t		m_minOctave;					// First level used by the fits
+		uint32_t		m_minSamples;					// Samples needed for a level to be fitted
+
+		bool			m_started;						// A sample has been seen
+		Time			m_start;						// Start of the first bin
+		int64_t			m_bin;							// Index of the open bin
+		double			m_binBytes;						// Bytes in the open bin
+		double			m_binPackets;					// Packets in the open bin
+		std::vector<Level>	m_levels;					// Dyadic time scales
+	};
+
+} // namespace ns3
+#endif
@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This script runs many PPBP sources in a distributed (MPI) simulation.
+*  Every rank owns one router and the sources i with i % ranks equal to its
+*  rank; the routers are linked to the router of rank 0, which forwards all
+*  traffic to a sink. PPBPHelper only installs the sources of the local rank
+*  and numbers their random streams by global source index, so the sink
+*  receives the same traffic for any number of ranks.
+*  Rank 0 appends the wall-clock time of the run to timesFile and reports
+*  the speedup against the last single-process run recorded there.
+*  Example run (ns-3 configured with --enable-mpi): Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-mpi-test --sources=1024"
+*  ./waf --command-template="mpirun -np 4 %s --sources=1024" --run scratch/PPBP-mpi-test
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
+#include <chrono>
+#include <fstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPMpiExample");
+
+int
+main (int argc, char *argv[])
+{
+  double simulationTime = 10; //seconds
+  uint32_t sources = 64;
+  std::string timesFile = "ppbp-mpi-times.txt";
+
+  CommandLine cmd;
+  cmd.AddValue ("simulationTime", "Simulation time", simulationTime);
+  cmd.AddValue ("sources", "Number of PPBP sources over all ranks", sources);
+  cmd.AddValue ("timesFile", "File recording the wall-clock time of each run", timesFile);
+  cmd.Parse (argc, argv);
+
+  Time::SetResolution (Time::NS);
+
+  uint32_t systemId = 0;
+  uint32_t systemCount = 1;
+#ifdef NS3_MPI
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+  MpiInterface::Enable (&argc, &argv);
+  systemId = MpiInterface::GetSystemId ();
+  systemCount = MpiInterface::GetSize ();
+#endif
+
+  // Every rank builds the whole topology
+  NodeContainer routers;
+  for (uint32_t r = 0; r < systemCount; ++r)
+    {
+      routers.Create (1, r);
+    }
+  NodeContainer sink;
+  sink.Create (1, 0);
+  NodeContainer sourceNodes;
+  for (uint32_t i = 0; i < sources; ++i)
+    {
+      sourceNodes.Create (1, i % systemCount);
+    }
+
+  InternetStackHelper stack;
+  stack.Install (routers);
+  stack.Install (sink);
+  stack.Install (sourceNodes);
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper core;
+  core.SetDeviceAttribute ("DataRate", StringValue ("100Gbps"));
+  core.SetChannelAttribute ("Delay", StringValue ("5ms"));
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  Ipv4InterfaceContainer sinkInterfaces = address.Assign (core.Install (sink.Get (0), routers.Get (0)));
+  address.NewNetwork ();
+  for (uint32_t r = 1; r < systemCount; ++r)
+    {
+      address.Assign (core.Install (routers.Get (r), routers.Get (0)));
+      address.NewNetwork ();
+    }
+  for (uint32_t i = 0; i < sources; ++i)
+    {
+      address.Assign (access.Install (sourceNodes.Get (i), routers.Get (i % systemCount)));
+      address.NewNetwork ();
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint32_t socketPort = 9;
+  Ptr<PacketSink> packetSink;
+  if (systemId == 0)
+    {
+      PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), socketPort));
+      packetSink = DynamicCast<PacketSink> (sinkHelper.Install (sink.Get (0)).Get (0));
+    }
+
+  PPBPHelper ppbp = PPBPHelper ("ns3::UdpSocketFactory",
+                                InetSocketAddress (sinkInterfaces.GetAddress (0), socketPort));
+  ApplicationContainer apps = ppbp.Install (sourceNodes);
+  ppbp.AssignStreams (sourceNodes, 0);
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (simulationTime));
+
+  Simulator::Stop (Seconds (simulationTime));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  uint64_t sent = 0;
+  for (uint32_t i = 0; i < apps.GetN (); ++i)
+    {
+      sent += DynamicCast<PPBPApplication> (apps.Get (i))->GetTotalBytes ();
+    }
+  NS_LOG_UNCOND ("Rank " << systemId << ": " << apps.GetN () << " sources sent " << sent << " bytes");
+
+  if (systemId == 0)
+    {
+      NS_LOG_UNCOND ("Sink received " << packetSink->GetTotalRx () << " bytes");
+      NS_LOG_UNCOND (systemCount << " rank(s): " << wall << " s wall-clock");
+
+      double serial = 0;
+      std::ifstream in (timesFile.c_str ());
+      uint32_t ranks, n;
+      double t;
+      while (in >> ranks >> n >> t)
+        {
+          if (ranks == 1 && n == sources)
+            {
+              serial = t;
+            }
+        }
+      in.close ();
+      if (systemCount == 1)
+        {
+          serial = wall;
+        }
+      std::ofstream out (timesFile.c_str (), std::ios::app);
+      out << systemCount << " " << sources << " " << wall << std::endl;
+      if (serial > 0)
+        {
+          NS_LOG_UNCOND ("Speedup against a single process: " << serial / wall);
+        }
+      else
+        {
+          NS_LOG_UNCOND ("Run once without mpirun to record the single-process time");
+        }
+    }
+
+  Simulator::Destroy ();
+#ifdef NS3_MPI
+  MpiInterface::Disable ();
+#endif
+  return 0;
+}
@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-mux-application.h"
+#include "ns3/log.h"
+#include "ns3/address.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/udp-socket-factory.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPMuxApplication");
+
+namespace ns3 {
+
+	NS_OBJECT_ENSURE_REGISTERED (PPBPMuxApplication);
+
+	TypeId
+	PPBPMuxApplication::GetTypeId (void)
+	{
+		static TypeId tid = TypeId ("ns3::PPBPMuxApplication")
+		.SetParent<Application> ()
+		.AddConstructor<PPBPMuxApplication> ()
+		.AddAttribute ("Protocol", "The type of protocol to use.",
+					   TypeIdValue (UdpSocketFactory::GetTypeId ()),
+					   MakeTypeIdAccessor (&PPBPMuxApplication::m_protocolTid),
+					   MakeTypeIdChecker ())
+		.AddAttribute ("HeaderOverhead", "Bytes of lower-layer headers added to each packet "
+					   "when pacing the bursts.",
+					   UintegerValue (30),
+					   MakeUintegerAccessor (&PPBPMuxApplication::m_headerOverhead),
+					   MakeUintegerChecker<uint32_t> ())
+		.AddTraceSource ("Tx", "A new packet is created and is sent",
+						 MakeTraceSourceAccessor (&PPBPMuxApplication::m_txTrace),
+						 "ns3::Packet::TracedCallback")
+		;
+		return tid;
+	}
+
+	PPBPMuxApplication::PPBPMuxApplication ()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		m_totalBytes = 0;
+		m_headerOverhead = 30;
+		m_arrivalVariate = CreateObject<ExponentialRandomVariable> ();
+		m_lengthVariate = CreateObject<ParetoRandomVariable> ();
+	}
+
+	PPBPMuxApplication::~PPBPMuxApplication()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+	}
+
+	uint32_t
+	PPBPMuxApplication::AddSource (Address remote, double burstArrivals, double burstLength,
+								   double h, DataRate burstIntensity, uint32_t packetSize)
+	{
+		NS_LOG_FUNCTION (this << burstArrivals << burstLength << h << packetSize);
+
+		std::map<Address, uint32_t>::const_iterator it = m_remoteIndex.find (remote);
+		uint32_t r;
+		if (it == m_remoteIndex.end ())
+		{
+			r = m_remotes.size ();
+			m_remotes.push_back (remote);
+			m_remoteIndex[remote] = r;
+		}
+		else
+		{
+			r = it->second;
+		}
+
+		double shape = 3 - 2 * h;
+		m_meanInterval.push_back (1 / burstArrivals);
+		m_scale.push_back ((shape - 1) * burstLength / shape);
+		m_shape.push_back (shape);
+		m_cost.push_back (0);					// Set in StartApplication, with HeaderOverhead
+		m_burstRate.push_back (burstIntensity.GetBitRate ());
+		m_pktSize.push_back (packetSize);
+		m_remote.push_back (r);
+		m_active.push_back (0);
+		m_credit.push_back (0);
+		m_last.push_back (0);
+		m_nextTx.push_back (-1);
+		return m_pktSize.size () - 1;
+	}
+
+	uint32_t
+	PPBPMuxApplication::GetNSources () const
+	{
+		return m_pktSize.size ();
+	}
+
+	uint64_t
+	PPBPMuxApplication::GetTotalBytes() const
+	{
+		return m_totalBytes;
+	}
+
+	int64_t
+	PPBPMuxApplication::AssignStreams (int64_t stream)
+	{
+		NS_LOG_FUNCTION (this << stream);
+		m_arrivalVariate->SetStream (stream);
+		m_lengthVariate->SetStream (stream + 1);
+		return 2;
+	}
+
+	void
+	PPBPMuxApplication::DoDispose (void)
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+
+		m_sockets.clear ();
+		m_packetTemplates.clear ();
+		m_arrivalVariate = 0;
+		m_lengthVariate = 0;
+		// chain up
+		Application::DoDispose ();
+	}
+
+	void
+	PPBPMuxApplication::StartApplication() // Called at time specified by Start
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+
+		// One socket per distinct destination, shared by its sources
+		if (m_sockets.empty ())
+		{
+			for (uint32_t r = 0; r < m_remotes.size (); ++r)
+			{
+				Ptr<Socket> socket = Socket::CreateSocket (GetNode(), m_protocolTid);
+				socket->Bind ();
+				socket->Connect (m_remotes[r]);
+				m_sockets.push_back (socket);
+			}
+		}
+
+		Simulator::Cancel (m_timer);
+		m_events = std::priority_queue<Event, std::vector<Event>, std::greater<Event> > ();
+		int64_t now = Simulator::Now ().GetTimeStep ();
+		for (uint32_t s = 0; s < m_pktSize.size (); ++s)
+		{
+			uint64_t bits = (uint64_t) (m_pktSize[s] + m_headerOverhead) * 8;
+			m_cost[s] = std::max<uint64_t> (1, bits * Seconds (1).GetTimeStep ());
+			m_active[s] = 0;
+			m_credit[s] = 0;
+			m_last[s] = now;
+			m_nextTx[s] = -1;
+			DrawArrival (s, now);
+		}
+		ScheduleTimer ();
+	}
+
+	void
+	PPBPMuxApplication::StopApplication() // Called at time specified by Stop
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+
+		Simulator::Cancel (m_timer);
+		for (uint32_t r = 0; r < m_sockets.size (); ++r)
+		{
+			m_sockets[r]->Close ();
+		}
+	}
+
+	void
+	PPBPMuxApplication::Push (int64_t time, uint32_t source, EventType type)
+	{
+		Event e;
+		e.time = time;
+		e.source = source;
+		e.type = type;
+		m_events.push (e);
+	}
+
+	void
+	PPBPMuxApplication::ProcessEvents()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		int64_t now = Simulator::Now ().GetTimeStep ();
+
+		while (!m_events.empty () && m_events.top ().time <= now)
+		{
+			Event e = m_events.top ();
+			m_events.pop ();
+			uint32_t s = e.source;
+			switch (e.type)
+			{
+			case DEPARTURE:
+				Accrue (s, now);
+				--m_active[s];
+				ScheduleNextTx (s, now);		// The pending TX follows the new rate
+				break;
+			case ARRIVAL:
+				{
+					Accrue (s, now);
+					++m_active[s];
+					double length = m_lengthVariate->GetValue (m_scale[s], m_shape[s], 0);
+					Push (now + Seconds (length).GetTimeStep (), s, DEPARTURE);
+					DrawArrival (s, now);
+					ScheduleNextTx (s, now);
+				}
+				break;
+			case TX:
+				if (e.time != m_nextTx[s])
+				{
+					break;						// Paced again since it was pushed
+				}
+				m_nextTx[s] = -1;
+				SendPacket (s);
+				Accrue (s, now);
+				m_credit[s] = m_credit[s] > m_cost[s] ? m_credit[s] - m_cost[s] : 0;
+				ScheduleNextTx (s, now);
+				break;
+			}
+		}
+		ScheduleTimer ();
+	}
+
+	void
+	PPBPMuxApplication::ScheduleTimer()
+	{
+		Simulator::Cancel (m_timer);
+		if (!m_events.empty ())
+		{
+			Time next = TimeStep (m_events.top ().time);
+			m_timer = Simulator::Schedule (next - Simulator::Now (), &PPBPMuxApplication::ProcessEvents, this);
+		}
+	}
+
+	void
+	PPBPMuxApplication::DrawArrival (uint32_t source, int64_t now)
+	{
+		double interval = m_arrivalVariate->GetValue (m_meanInterval[source], 0);
+		Push (now + Seconds (interval).GetTimeStep (), source, ARRIVAL);
+	}
+
+	void
+	PPBPMuxApplication::Accrue (uint32_t source, int64_t now)
+	{
+		// Same integer credit as PPBPPacer::Accrue
+		if (now > m_last[source])
+		{
+			m_credit[source] += (uint64_t) (now - m_last[source]) * m_active[source] * m_burstRate[source];
+			m_last[source] = now;
+		}
+	}
+
+	void
+	PPBPMuxApplication::ScheduleNextTx (uint32_t source, int64_t now)
+	{
+		// The credit is up to date at now; same departure time as PPBPPacer::GetNextTime
+		uint64_t rate = (uint64_t) m_active[source] * m_burstRate[source];
+		if (rate == 0)
+		{
+			m_nextTx[source] = -1;
+			return;
+		}
+		int64_t next = m_last[source];
+		if (m_credit[source] < m_cost[source])
+		{
+			next += (int64_t) ((m_cost[source] - m_credit[source] + rate - 1) / rate);
+		}
+		if (next != m_nextTx[source])
+		{
+			m_nextTx[source] = next;
+			Push (next, source, TX);
+		}
+	}
+
+	void
+	PPBPMuxApplication::SendPacket (uint32_t source)
+	{
+		// One payload per size; every packet sent is a copy-on-write copy of it
+		Ptr<Packet> &payload = m_packetTemplates[m_pktSize[source]];
+		if (!payload)
+		{
+			payload = Create<Packet> (m_pktSize[source]);
+		}
+		Ptr<Packet> packet = payload->Copy ();
+		m_txTrace (packet);
+		m_sockets[m_remote[source]]->Send (packet);
+		m_totalBytes += packet->GetSize ();
+	}
+
+} // namespace ns3
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_mux_application_h__
+#define __PPBP_mux_application_h__
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include <functional>
+#include <map>
+#include <queue>
+#include <vector>
+
+namespace ns3 {
+
+	class Socket;
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Drive many logical PPBP sources from one application.
+	 *
+	 * Each logical source follows the same process as a PPBPApplication:
+	 * Poisson burst arrivals, Pareto burst lengths and packets paced at
+	 * n(t) x r by the integer credit of PPBPPacer, so the long-run rate has
+	 * no rounding drift. Its parameters are constants (not random variables)
+	 * and its state, pacer credit included, lives in one slot of a set of
+	 * parallel arrays, a few tens of bytes per source. All sources share one
+	 * socket per distinct destination, one pair of random variables and a
+	 * single simulator event, armed at the earliest entry of a shared event
+	 * heap. The heap
+	 * holds the next arrival of every source, the next transmission of every
+	 * active source and the end of every active burst. When the number of
+	 * active bursts of a source changes, its next transmission is paced
+	 * again at the new rate; the entry already in the heap is then stale
+	 * and skipped when it comes up.
+	 */
+	class PPBPMuxApplication : public Application
+	{
+	public:
+		static TypeId GetTypeId (void);
+
+		PPBPMuxApplication ();
+
+		virtual ~PPBPMuxApplication();
+
+		/**
+		 * \brief Add a logical source. Sources must be added before the
+		 * application starts; HeaderOverhead is applied to every source
+		 * when it does, whenever the attribute was set.
+		 *
+		 * \param remote destination of the source
+		 * \param burstArrivals mean rate of burst arrivals (1/s)
+		 * \param burstLength mean burst time length (s)
+		 * \param h Hurst parameter
+		 * \param burstIntensity constant bit-rate of each burst
+		 * \param packetSize size of the packets (bytes)
+		 * \return the index of the source
+		 */
+		uint32_t      AddSource (Address remote, double burstArrivals, double burstLength,
+								 double h, DataRate burstIntensity, uint32_t packetSize);
+
+		uint32_t      GetNSources () const;
+
+		/**
+		 * \brief Return total bytes sent by this object.
+		 */
+		uint64_t      GetTotalBytes() const;
+
+		/**
+		 * \brief Assign a fixed random variable stream number to the random variables
+		 * used by this model.
+		 *
+		 * \param stream first stream index to use
+		 * \return the number of stream indices assigned by this model
+		 */
+		int64_t       AssignStreams (int64_t stream);
+
+	protected:
+		virtual void DoDispose ();
+
+	private:
+		// Inherited from Application base class.
+		virtual void StartApplication ();				// Called at time specified by Start
+		virtual void StopApplication ();				// Called at time specified by Stop
+
+		enum EventType
+		{
+			DEPARTURE = 0,								// Departures first at equal times
+			ARRIVAL = 1,
+			TX = 2
+		};
+
+		struct Event
+		{
+			int64_t		time;							// In time steps
+			uint32_t	source;
+			uint32_t	type;							// EventType
+
+			bool operator> (const Event &o) const
+			{
+				if (time != o.time) return time > o.time;
+				if (source != o.source) return source > o.source;
+				return type > o.type;
+			}
+		};
+
+		void Push (int64_t time, uint32_t source, EventType type);
+		void ProcessEvents ();
+		void ScheduleTimer ();
+		void DrawArrival (uint32_t source, int64_t now);
+		void Accrue (uint32_t source, int64_t now);
+		void ScheduleNextTx (uint32_t source, int64_t now);
+		void SendPacket (uint32_t source);
+
+		TypeId          m_protocolTid;					// protocol type id
+		uint32_t		m_headerOverhead;				// Bytes added to each packet when pacing
+		std::vector<Address>		m_remotes;			// Distinct destinations
+		std::vector<Ptr<Socket> >	m_sockets;			// One socket per destination
+		std::map<Address, uint32_t>	m_remoteIndex;		// Destination to index into m_remotes
+
+		// Per-source parameters and state (one slot per source)
+		std::vector<double>		m_meanInterval;			// 1 / lambda_p (s)
+		std::vector<double>		m_scale;				// Pareto scale (s)
+		std::vector<double>		m_shape;				// Pareto shape
+		std::vector<uint64_t>	m_cost;					// Bits per packet x steps per second
+		std::vector<uint64_t>	m_burstRate;			// Bit-rate of one burst
+		std::vector<uint32_t>	m_pktSize;				// Size of packets
+		std::vector<uint32_t>	m_remote;				// Index into m_remotes
+		std::vector<uint32_t>	m_active;				// Number of active bursts
+		std::vector<uint64_t>	m_credit;				// Pacer credit carried over
+		std::vector<int64_t>	m_last;					// Time step the credit is counted up to
+		std::vector<int64_t>	m_nextTx;				// Time of the valid TX in the heap, -1 for none
+		std::map<uint32_t, Ptr<Packet> >	m_packetTemplates;	// Payload copied for every packet, by size
+
+		std::priority_queue<Event, std::vector<Event>, std::greater<Event> >
+						m_events;						// Shared event heap
+		EventId			m_timer;						// Single pending simulator event
+
+		Ptr<ExponentialRandomVariable>	m_arrivalVariate;	// Inter-burst intervals
+		Ptr<ParetoRandomVariable>		m_lengthVariate;	// Burst lengths
+
+		uint64_t        m_totalBytes;					// Total bytes sent so far
+
+		TracedCallback< Ptr<const Packet> > m_txTrace;	// Trace callback for each sent packet
+	};
+
+} // namespace ns3
+#endif
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-mux-helper.h"
+#include "ns3/PPBP-mux-application.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/packet-socket-address.h"
+#include "ns3/string.h"
+#include "ns3/names.h"
+
+namespace ns3 {
+
+PPBPMuxHelper::PPBPMuxHelper (std::string protocol)
+{
+  m_factory.SetTypeId ("ns3::PPBPMuxApplication");
+  m_factory.Set ("Protocol", StringValue (protocol));
+}
+
+void 
+PPBPMuxHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+void
+PPBPMuxHelper::AddSource (Address remote, double burstArrivals, double burstLength,
+                          double h, DataRate burstIntensity, uint32_t packetSize)
+{
+  Source source;
+  source.remote = remote;
+  source.burstArrivals = burstArrivals;
+  source.burstLength = burstLength;
+  source.h = h;
+  source.burstIntensity = burstIntensity;
+  source.packetSize = packetSize;
+  m_sources.push_back (source);
+}
+
+ApplicationContainer
+PPBPMuxHelper::Install (Ptr<Node> node) const
+{
+  return ApplicationContainer (InstallPriv (node));
+}
+
+ApplicationContainer
+PPBPMuxHelper::Install (std::string nodeName) const
+{
+  Ptr<Node> node = Names::Find<Node> (nodeName);
+  return ApplicationContainer (InstallPriv (node));
+}
+
+ApplicationContainer
+PPBPMuxHelper::Install (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      apps.Add (InstallPriv (*i));
+    }
+
+  return apps;
+}
+
+int64_t
+PPBPMuxHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  Ptr<Node> node;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      node = (*i);
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          Ptr<PPBPMuxApplication> ppbp = DynamicCast<PPBPMuxApplication> (node->GetApplication (j));
+          if (ppbp)
+            {
+              currentStream += ppbp->AssignStreams (currentStream);
+            }
+        }
+    }
+  return (currentStream - stream);
+}
+
+Ptr<Application>
+PPBPMuxHelper::InstallPriv (Ptr<Node> node) const
+{
+  Ptr<PPBPMuxApplication> app = m_factory.Create<PPBPMuxApplication> ();
+  for (std::vector<Source>::const_iterator i = m_sources.begin (); i != m_sources.end (); ++i)
+    {
+      app->AddSource (i->remote, i->burstArrivals, i->burstLength,
+                      i->h, i->burstIntensity, i->packetSize);
+    }
+  node->AddApplication (app);
+
+  return app;
+}
+
+} // namespace ns3
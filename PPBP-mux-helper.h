@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PPBP_MUX_HELPER_H
+#define PPBP_MUX_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/object-factory.h"
+#include "ns3/address.h"
+#include "ns3/attribute.h"
+#include "ns3/net-device.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+#include "ns3/data-rate.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief A helper to install one ns3::PPBPMuxApplication per node, each
+ * driving the same set of logical PPBP sources.
+ */
+class PPBPMuxHelper
+{
+public:
+  /**
+   * Create an Helper to make it easier to work with Applications
+   *
+   * \param protocol the name of the protocol to use to send traffic
+   *        by the applications. This string identifies the socket
+   *        factory type used to create sockets for the applications.
+   *        A typical value would be ns3::UdpSocketFactory.
+   */
+  PPBPMuxHelper (std::string protocol);
+
+  /**
+   * Helper function used to set the underlying application attributes.
+   *
+   * \param name the name of the application attribute to set
+   * \param value the value of the application attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Add a logical source to every application installed afterwards.
+   *
+   * \param remote destination of the source
+   * \param burstArrivals mean rate of burst arrivals (1/s)
+   * \param burstLength mean burst time length (s)
+   * \param h Hurst parameter
+   * \param burstIntensity constant bit-rate of each burst
+   * \param packetSize size of the packets (bytes)
+   */
+  void AddSource (Address remote, double burstArrivals = 20.0, double burstLength = 0.2,
+                  double h = 0.7, DataRate burstIntensity = DataRate ("1Mb/s"),
+                  uint32_t packetSize = 1470);
+
+  /**
+   * Install an ns3::Application on each node of the input container
+   * configured with all the attributes set with SetAttribute.
+   *
+   * \param c NodeContainer of the set of nodes on which an Application
+   * will be installed.
+   * \returns Container of Ptr to the applications installed.
+   */
+  ApplicationContainer Install (NodeContainer c) const;
+
+  /**
+   * Install an ns3::Application on the node configured with all the
+   * attributes set with SetAttribute.
+   *
+   * \param node The node on which an Application will be installed.
+   * \returns Container of Ptr to the applications installed.
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+  /**
+   * Install an ns3::Application on the node configured with all the
+   * attributes set with SetAttribute.
+   *
+   * \param nodeName The node on which an Application will be installed.
+   * \returns Container of Ptr to the applications installed.
+   */
+  ApplicationContainer Install (std::string nodeName) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.  The Install() method should have previously been
+   * called by the user.
+   *
+   * \param stream first stream index to use
+   * \param c NodeContainer of the set of nodes for which the PPBPMuxApplication
+   *          should be modified to use a fixed stream
+   * \return the number of stream indices assigned by this helper
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
+
+private:
+  /**
+   * \internal
+   * Install an ns3::Application on the node configured with all the
+   * attributes set with SetAttribute.
+   *
+   * \param node The node on which an Application will be installed.
+   * \returns Ptr to the application installed.
+   */
+  Ptr<Application> InstallPriv (Ptr<Node> node) const;
+  struct Source
+  {
+    Address remote;
+    double burstArrivals;
+    double burstLength;
+    double h;
+    DataRate burstIntensity;
+    uint32_t packetSize;
+  };
+
+  ObjectFactory m_factory;
+  std::vector<Source> m_sources;
+};
+
+} // namespace ns3
+
+#endif /* PPBP_MUX_HELPER_H */
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-pacer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+	PPBPPacer::PPBPPacer ()
+		: m_cost (1),
+		  m_stepsPerSecond (1),
+		  m_burstRate (0),
+		  m_active (0),
+		  m_credit (0),
+		  m_last (0)
+	{
+	}
+
+	void
+	PPBPPacer::SetPacketBits (uint64_t bits, int64_t stepsPerSecond)
+	{
+		m_cost = std::max<uint64_t> (1, bits * stepsPerSecond);
+		m_stepsPerSecond = stepsPerSecond;
+	}
+
+	void
+	PPBPPacer::SetBurstRate (uint64_t bitRate)
+	{
+		m_burstRate = bitRate;
+	}
+
+	void
+	PPBPPacer::Reset (int64_t now)
+	{
+		m_active = 0;
+		m_credit = 0;
+		m_last = now;
+	}
+
+	void
+	PPBPPacer::Accrue (int64_t now)
+	{
+		if (now > m_last)
+		{
+			m_credit += (uint64_t) (now - m_last) * m_active * m_burstRate;
+			m_last = now;
+		}
+	}
+
+	void
+	PPBPPacer::SetActive (int64_t now, uint32_t active)
+	{
+		Accrue (now);
+		m_active = active;
+	}
+
+	void
+	PPBPPacer::Consume (int64_t now, uint32_t packets)
+	{
+		Accrue (now);
+		uint64_t cost = packets * m_cost;
+		m_credit = m_credit > cost ? m_credit - cost : 0;
+	}
+
+	void
+	PPBPPacer::ConsumeBits (int64_t now, uint64_t bits)
+	{
+		Accrue (now);
+		uint64_t cost = std::max<uint64_t> (1, bits * m_stepsPerSecond);
+		m_credit = m_credit > cost ? m_credit - cost : 0;
+	}
+
+	int64_t
+	PPBPPacer::GetNextTime (uint32_t packets) const
+	{
+		return GetNextTimeCost (packets * m_cost);
+	}
+
+	int64_t
+	PPBPPacer::GetNextTimeBits (uint64_t bits) const
+	{
+		return GetNextTimeCost (std::max<uint64_t> (1, bits * m_stepsPerSecond));
+	}
+
+	int64_t
+	PPBPPacer::GetNextTimeCost (uint64_t cost) const
+	{
+		uint64_t rate = (uint64_t) m_active * m_burstRate;
+		if (rate == 0)
+		{
+			return -1;
+		}
+		if (m_credit >= cost)
+		{
+			return m_last;
+		}
+		return m_last + (int64_t) ((cost - m_credit + rate - 1) / rate);
+	}
+
+	uint32_t
+	PPBPPacer::GetTrainLength (int64_t jitter, uint32_t max) const
+	{
+		// Only bounds the error, so double precision is enough here
+		double rate = (double) m_active * m_burstRate;
+		double k = 1 + std::floor (std::max<int64_t> (0, jitter) * rate / m_cost);
+		return (uint32_t) std::min (k, (double) max);
+	}
+
+	uint64_t
+	PPBPPacer::GetCredit () const
+	{
+		return m_credit;
+	}
+
+	int64_t
+	PPBPPacer::GetLast () const
+	{
+		return m_last;
+	}
+
+	uint32_t
+	PPBPPacer::GetActive () const
+	{
+		return m_active;
+	}
+
+	void
+	PPBPPacer::Restore (int64_t last, uint32_t active, uint64_t credit)
+	{
+		m_last = last;
+		m_active = active;
+		m_credit = credit;
+	}
+
+} // namespace ns3
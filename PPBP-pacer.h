@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_pacer_h__
+#define __PPBP_pacer_h__
+
+#include <stdint.h>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Integer credit pacer for the n(t) x r packet departures.
+	 *
+	 * Time is counted in simulator time steps. While n bursts are active,
+	 * every time step earns n x r bit/s worth of credit; a packet costs
+	 * its size in bits times the number of steps per second. Both are exact
+	 * integers, so the remainder left after each packet carries over to the
+	 * next one and the long-run packet rate is exactly the integral of
+	 * n(t) x r over the packet size, with no rounding drift.
+	 *
+	 * The credit is brought up to date whenever the number of active bursts
+	 * changes, so the next departure time always reflects the current rate.
+	 */
+	class PPBPPacer
+	{
+	public:
+		PPBPPacer ();
+
+		/**
+		 * \brief Set the cost of one packet, and the simulator time steps per second.
+		 */
+		void SetPacketBits (uint64_t bits, int64_t stepsPerSecond);
+
+		/**
+		 * \brief Set the bit-rate of one burst.
+		 */
+		void SetBurstRate (uint64_t bitRate);
+
+		/**
+		 * \brief Drop the credit and the active bursts; start counting at now.
+		 */
+		void Reset (int64_t now);
+
+		/**
+		 * \brief Change the number of active bursts at time now.
+		 */
+		void SetActive (int64_t now, uint32_t active);
+
+		/**
+		 * \brief Pay for packets sent at time now.
+		 */
+		void Consume (int64_t now, uint32_t packets);
+
+		/**
+		 * \brief Pay for a given number of bits sent at time now, for packets
+		 * of other sizes than SetPacketBits.
+		 */
+		void ConsumeBits (int64_t now, uint64_t bits);
+
+		/**
+		 * \return the earliest time step at which that many packets can
+		 * leave, or -1 when no burst is active.
+		 */
+		int64_t GetNextTime (uint32_t packets) const;
+
+		/**
+		 * \return the earliest time step at which that many bits can leave,
+		 * or -1 when no burst is active.
+		 */
+		int64_t GetNextTimeBits (uint64_t bits) const;
+
+		/**
+		 * \return the number of packets that can leave together while none
+		 * is more than jitter time steps away from its paced time, at most max.
+		 */
+		uint32_t GetTrainLength (int64_t jitter, uint32_t max) const;
+
+		/**
+		 * \return the credit carried over, in bit x time steps per second.
+		 */
+		uint64_t GetCredit () const;
+
+		/**
+		 * \return the time step the credit is counted up to.
+		 */
+		int64_t GetLast () const;
+
+		/**
+		 * \return the number of active bursts.
+		 */
+		uint32_t GetActive () const;
+
+		/**
+		 * \brief Set the state saved with GetLast, GetActive and GetCredit.
+		 */
+		void Restore (int64_t last, uint32_t active, uint64_t credit);
+
+	private:
+		void Accrue (int64_t now);
+		int64_t GetNextTimeCost (uint64_t cost) const;
+
+		uint64_t	m_cost;							// Bits per packet x steps per second
+		int64_t		m_stepsPerSecond;				// Simulator time steps per second
+		uint64_t	m_burstRate;					// Bit-rate of one burst
+		uint32_t	m_active;						// Active bursts
+		uint64_t	m_credit;						// Credit carried over
+		int64_t		m_last;							// Time step the credit is counted up to
+	};
+
+} // namespace ns3
+#endif
@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-pcapng.h"
+#include "PPBP-trace.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPPcapng");
+
+namespace ns3 {
+
+	static const size_t g_pcapngBuffer = 4 * 1024 * 1024;			// Bytes per write
+	static const uint32_t g_frameHeader = 42;						// Ethernet + IPv4 + UDP
+
+	std::map<std::string, PPBPPcapngWriter *> PPBPPcapngWriter::m_open;
+
+	namespace {
+
+		void
+		PutBig16 (uint8_t *p, uint16_t v)
+		{
+			p[0] = v >> 8;
+			p[1] = v & 0xff;
+		}
+
+		void
+		PutBig32 (uint8_t *p, uint32_t v)
+		{
+			PutBig16 (p, v >> 16);
+			PutBig16 (p + 2, v & 0xffff);
+		}
+
+	} // anonymous namespace
+
+	PPBPPcapngWriter::PPBPPcapngWriter ()
+		: m_file (0),
+		  m_snapLength (65535),
+		  m_nextSource (0),
+		  m_count (0),
+		  m_error (false)
+	{
+	}
+
+	PPBPPcapngWriter::~PPBPPcapngWriter ()
+	{
+		Close ();
+	}
+
+	bool
+	PPBPPcapngWriter::Open (const std::string &filename, uint32_t snapLength)
+	{
+		NS_LOG_FUNCTION (this << filename << snapLength);
+		Close ();
+		m_file = fopen (filename.c_str (), "wb");
+		if (!m_file)
+		{
+			NS_LOG_ERROR ("Cannot create pcapng file " << filename);
+			return false;
+		}
+		m_filename = filename;
+		m_snapLength = snapLength;
+		m_count = 0;
+		m_error = false;
+		m_buffer.clear ();
+		m_buffer.reserve (g_pcapngBuffer + 128 + snapLength);
+
+		// Section Header Block, in host byte order as told by its magic
+		uint32_t shb[7] = { 0x0A0D0D0A, 28, 0x1A2B3C4D, 0, 0xffffffff, 0xffffffff, 28 };
+		uint16_t version[2] = { 1, 0 };
+		memcpy (&shb[3], version, sizeof (version));
+		Append (shb, sizeof (shb));
+		// Interface Description Block: Ethernet, option if_tsresol = 10^-9
+		uint32_t idb[8] = { 1, 32, 0, snapLength, 0, 0, 0, 32 };
+		uint16_t linkType[2] = { 1, 0 };
+		uint16_t tsresol[2] = { 9, 1 };
+		memcpy (&idb[2], linkType, sizeof (linkType));
+		memcpy (&idb[4], tsresol, sizeof (tsresol));
+		reinterpret_cast<uint8_t *> (&idb[5])[0] = 9;	// Then three bytes of padding
+		Append (idb, sizeof (idb));
+		return true;
+	}
+
+	void
+	PPBPPcapngWriter::SetSource (uint32_t source, uint32_t srcIp, uint16_t srcPort, uint32_t dstIp, uint16_t dstPort)
+	{
+		if (source >= m_sources.size ())
+		{
+			m_sources.resize (source + 1);
+			m_sourceSet.resize (source + 1, false);
+		}
+		m_sourceSet[source] = true;
+		Source &s = m_sources[source];
+		uint8_t *h = s.header;
+		memset (h, 0, sizeof (s.header));
+
+		// Ethernet: locally administered MACs
+		h[0] = 0x02;
+		PutBig32 (h + 2, dstIp);
+		h[6] = 0x02;
+		PutBig32 (h + 8, srcIp);
+		PutBig16 (h + 12, 0x0800);
+
+		// IPv4: total length, identification and checksum are set per packet
+		uint8_t *ip = h + 14;
+		ip[0] = 0x45;
+		PutBig16 (ip + 6, 0x4000);			// Don't fragment
+		ip[8] = 64;
+		ip[9] = 17;
+		PutBig32 (ip + 12, srcIp);
+		PutBig32 (ip + 16, dstIp);
+		s.checksum = 0;
+		for (uint32_t i = 0; i < 20; i += 2)
+		{
+			s.checksum += (ip[i] << 8) | ip[i + 1];
+		}
+
+		// UDP: length set per packet, no checksum
+		uint8_t *udp = ip + 20;
+		PutBig16 (udp, srcPort);
+		PutBig16 (udp + 2, dstPort);
+		s.id = 0;
+	}
+
+	uint32_t
+	PPBPPcapngWriter::AddSource (uint32_t dstIp, uint16_t dstPort)
+	{
+		uint32_t source = m_nextSource++;
+		SetSource (source, 0x0a000000 + source + 1, 49152 + source % 16384, dstIp, dstPort);
+		return source;
+	}
+
+	PPBPPcapngWriter::Source &
+	PPBPPcapngWriter::GetSource (uint32_t source)
+	{
+		if (source >= m_sourceSet.size () || !m_sourceSet[source])
+		{
+			SetSource (source, 0x0a000000 + source + 1, 49152 + source % 16384, 0x0afffffe, 9);
+		}
+		return m_sources[source];
+	}
+
+	void
+	PPBPPcapngWriter::Write (uint64_t timeNs, uint32_t size, uint32_t source)
+	{
+		NS_ABORT_MSG_IF (size > 65535 - 28, "UDP payload of " << size << " bytes does not fit an IPv4 packet");
+		Source &s = GetSource (source);
+		uint32_t length = g_frameHeader + size;
+		uint32_t captured = length < m_snapLength ? length : m_snapLength;
+		uint32_t padded = (captured + 3) & ~3u;
+		uint32_t total = 32 + padded;
+
+		uint32_t epb[7] = { 6, total, 0, (uint32_t) (timeNs >> 32), (uint32_t) timeNs, captured, length };
+		Append (epb, sizeof (epb));
+
+		// Fill in the per-packet fields of the header template
+		uint8_t *ip = s.header + 14;
+		uint16_t id = s.id++;
+		PutBig16 (ip + 2, 28 + size);
+		PutBig16 (ip + 4, id);
+		uint32_t sum = s.checksum + 28 + size + id;
+		sum = (sum & 0xffff) + (sum >> 16);
+		sum = (sum & 0xffff) + (sum >> 16);
+		PutBig16 (ip + 10, ~sum & 0xffff);
+		PutBig16 (ip + 24, 8 + size);
+
+		size_t at = m_buffer.size ();
+		m_buffer.resize (at + padded + 4);
+		uint8_t *p = &m_buffer[at];
+		uint32_t head = captured < g_frameHeader ? captured : g_frameHeader;
+		memcpy (p, s.header, head);
+		memset (p + head, 0, padded - head);
+		memcpy (p + padded, &total, 4);
+		++m_count;
+		if (m_buffer.size () >= g_pcapngBuffer)
+		{
+			Flush ();
+		}
+	}
+
+	void
+	PPBPPcapngWriter::Append (const void *data, size_t size)
+	{
+		const uint8_t *p = static_cast<const uint8_t *> (data);
+		m_buffer.insert (m_buffer.end (), p, p + size);
+	}
+
+	bool
+	PPBPPcapngWriter::Flush ()
+	{
+		if (m_file && !m_buffer.empty ())
+		{
+			if (!m_error && fwrite (&m_buffer[0], 1, m_buffer.size (), m_file) != m_buffer.size ())
+			{
+				NS_LOG_ERROR ("Cannot write pcapng file " << m_filename);
+				m_error = true;
+			}
+			m_buffer.clear ();
+		}
+		return !m_error;
+	}
+
+	bool
+	PPBPPcapngWriter::Close ()
+	{
+		if (!m_file)
+		{
+			return !m_error;
+		}
+		NS_LOG_FUNCTION (this);
+		Flush ();
+		if (fclose (m_file) != 0)
+		{
+			NS_LOG_ERROR ("Cannot close pcapng file " << m_filename);
+			m_error = true;
+		}
+		m_file = 0;
+		std::map<std::string, PPBPPcapngWriter *>::iterator i = m_open.find (m_filename);
+		if (i != m_open.end () && i->second == this)
+		{
+			m_open.erase (i);
+		}
+		return !m_error;
+	}
+
+	uint64_t
+	PPBPPcapngWriter::GetPacketCount () const
+	{
+		return m_count;
+	}
+
+	Ptr<PPBPPcapngWriter>
+	PPBPPcapngWriter::Get (const std::string &filename, uint32_t snapLength)
+	{
+		std::map<std::string, PPBPPcapngWriter *>::iterator i = m_open.find (filename);
+		if (i != m_open.end ())
+		{
+			NS_ABORT_MSG_IF (i->second->m_snapLength != snapLength,
+							 "pcapng file " << filename << " is already open with snap length "
+							 << i->second->m_snapLength << ", not " << snapLength);
+			return Ptr<PPBPPcapngWriter> (i->second);
+		}
+		Ptr<PPBPPcapngWriter> writer = Create<PPBPPcapngWriter> ();
+		NS_ABORT_MSG_IF (!writer->Open (filename, snapLength), "Cannot create pcapng file " << filename);
+		m_open[filename] = PeekPointer (writer);
+		return writer;
+	}
+
+	uint64_t
+	PPBPPcapngWriter::Convert (const std::string &trace, const std::string &pcapng, uint32_t snapLength)
+	{
+		NS_LOG_FUNCTION (trace << pcapng << snapLength);
+		PPBPTraceReader reader;
+		NS_ABORT_MSG_IF (!reader.Open (trace), "Cannot read trace " << trace);
+		PPBPPcapngWriter writer;
+		NS_ABORT_MSG_IF (!writer.Open (pcapng, snapLength), "Cannot create pcapng file " << pcapng);
+		const PPBPTraceRecord *r;
+		while ((r = reader.Next ()) != 0)
+		{
+			writer.Write (r->timeNs, r->size, r->source);
+		}
+		NS_ABORT_MSG_IF (!writer.Close (), "Cannot write pcapng file " << pcapng);
+		return writer.GetPacketCount ();
+	}
+
+} // namespace ns3
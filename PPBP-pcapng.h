@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_pcapng_h__
+#define __PPBP_pcapng_h__
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Write synthetic Ethernet/IPv4/UDP frames to a pcapng file,
+	 *        without any socket, stack or device.
+	 *
+	 * The file holds one section with one Ethernet interface whose
+	 * timestamps are in nanoseconds, and one Enhanced Packet Block per
+	 * packet. Each source has a pre-built 42-byte header template
+	 * (addresses, ports, TTL); only the lengths, the IP identification and
+	 * the IP header checksum are filled in per packet, and the UDP checksum
+	 * is left at zero as IPv4 allows. Blocks are assembled in a large
+	 * user-space buffer that is written out in batches.
+	 *
+	 * Frames are captured up to the snap length; the zero payload beyond it
+	 * is only counted in the original length.
+	 *
+	 * The first failed write is latched; later blocks are dropped, and
+	 * Flush () and Close () return false from then on.
+	 */
+	class PPBPPcapngWriter : public SimpleRefCount<PPBPPcapngWriter>
+	{
+	public:
+		PPBPPcapngWriter ();
+		~PPBPPcapngWriter ();
+
+		/**
+		 * \brief Create (or truncate) the file and write the section and
+		 * interface blocks.
+		 * \return false if the file could not be created.
+		 */
+		bool Open (const std::string &filename, uint32_t snapLength = 65535);
+
+		/**
+		 * \brief Set the addresses of a source (host byte order). Sources not
+		 * set send from 10.0.0.0 + source + 1, port 49152 + source % 16384,
+		 * to 10.255.255.254, port 9.
+		 */
+		void SetSource (uint32_t source, uint32_t srcIp, uint16_t srcPort, uint32_t dstIp, uint16_t dstPort);
+
+		/**
+		 * \brief Add a source with the next free index.
+		 * \return its index
+		 */
+		uint32_t AddSource (uint32_t dstIp, uint16_t dstPort);
+
+		/**
+		 * \brief Write a packet of a given UDP payload size. Times must not
+		 * decrease for the file to be in order.
+		 */
+		void Write (uint64_t timeNs, uint32_t size, uint32_t source);
+
+		/**
+		 * \brief Write out the buffered blocks.
+		 * \return false if any write to the file failed.
+		 */
+		bool Flush ();
+
+		/**
+		 * \brief Flush and close the file.
+		 * \return false if any write to the file failed.
+		 */
+		bool Close ();
+
+		uint64_t GetPacketCount () const;
+
+		/**
+		 * \brief Return the writer shared by all users of a file, opening it
+		 * at the first call. The file is closed when the last user drops it.
+		 * All users of a file must ask for the same snap length.
+		 */
+		static Ptr<PPBPPcapngWriter> Get (const std::string &filename, uint32_t snapLength);
+
+		/**
+		 * \brief Write the packets of a PPBP trace as a pcapng file.
+		 * \return the number of packets written
+		 *
+		 * Aborts if the trace cannot be read or the pcapng file written.
+		 */
+		static uint64_t Convert (const std::string &trace, const std::string &pcapng, uint32_t snapLength = 65535);
+
+	private:
+		PPBPPcapngWriter (const PPBPPcapngWriter &);
+		PPBPPcapngWriter &operator= (const PPBPPcapngWriter &);
+
+		struct Source
+		{
+			uint8_t		header[42];						// Ethernet, IPv4 and UDP headers
+			uint32_t	checksum;						// IP checksum sum of the fixed words
+			uint16_t	id;								// Next IP identification
+		};
+
+		Source &GetSource (uint32_t source);
+		void Append (const void *data, size_t size);
+
+		FILE					*m_file;
+		std::string				m_filename;
+		uint32_t				m_snapLength;
+		std::vector<uint8_t>	m_buffer;
+		std::vector<Source>		m_sources;
+		std::vector<bool>		m_sourceSet;
+		uint32_t				m_nextSource;			// Next index of AddSource
+		uint64_t				m_count;
+		bool					m_error;				// A write has failed
+
+		static std::map<std::string, PPBPPcapngWriter *> m_open;	// Writers of Get, by file
+	};
+
+} // namespace ns3
+#endif
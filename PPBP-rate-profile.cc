@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-rate-profile.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPRateProfile");
+
+namespace ns3 {
+
+	NS_OBJECT_ENSURE_REGISTERED (PPBPRateProfile);
+	NS_OBJECT_ENSURE_REGISTERED (PPBPPiecewiseLinearRateProfile);
+	NS_OBJECT_ENSURE_REGISTERED (PPBPSinusoidalRateProfile);
+
+	TypeId
+	PPBPRateProfile::GetTypeId (void)
+	{
+		static TypeId tid = TypeId ("ns3::PPBPRateProfile")
+		.SetParent<Object> ()
+		;
+		return tid;
+	}
+
+	PPBPRateProfile::~PPBPRateProfile ()
+	{
+	}
+
+	TypeId
+	PPBPPiecewiseLinearRateProfile::GetTypeId (void)
+	{
+		static TypeId tid = TypeId ("ns3::PPBPPiecewiseLinearRateProfile")
+		.SetParent<PPBPRateProfile> ()
+		.AddConstructor<PPBPPiecewiseLinearRateProfile> ()
+		.AddAttribute ("Period", "Period over which the knots repeat, 0 for none.",
+					   TimeValue (Seconds (0)),
+					   MakeTimeAccessor (&PPBPPiecewiseLinearRateProfile::m_period),
+					   MakeTimeChecker ())
+		.AddAttribute ("Points", "Knots as \"time:multiplier,...\", times in seconds.",
+					   StringValue (""),
+					   MakeStringAccessor (&PPBPPiecewiseLinearRateProfile::SetPoints,
+										   &PPBPPiecewiseLinearRateProfile::GetPoints),
+					   MakeStringChecker ())
+		.AddAttribute ("File", "File of \"time multiplier\" lines, times in seconds.",
+					   StringValue (""),
+					   MakeStringAccessor (&PPBPPiecewiseLinearRateProfile::SetFile,
+										   &PPBPPiecewiseLinearRateProfile::GetFile),
+					   MakeStringChecker ())
+		;
+		return tid;
+	}
+
+	PPBPPiecewiseLinearRateProfile::PPBPPiecewiseLinearRateProfile ()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		m_period = Seconds (0);
+	}
+
+	void
+	PPBPPiecewiseLinearRateProfile::SetPoints (std::string points)
+	{
+		NS_LOG_FUNCTION (this << points);
+		m_points = points;
+		std::vector<std::pair<double, double> > knots;
+		std::istringstream in (points);
+		std::string item;
+		while (std::getline (in, item, ','))
+		{
+			double t, m;
+			char colon;
+			std::istringstream fields (item);
+			NS_ABORT_MSG_IF (!(fields >> t >> colon >> m) || colon != ':',
+							 "Bad rate profile point \"" << item << "\", expected time:multiplier");
+			knots.push_back (std::make_pair (t, m));
+		}
+		if (m_file.empty ())				// Else the file is used
+		{
+			SetKnots (knots);
+		}
+	}
+
+	std::string
+	PPBPPiecewiseLinearRateProfile::GetPoints () const
+	{
+		return m_points;
+	}
+
+	void
+	PPBPPiecewiseLinearRateProfile::SetFile (std::string fileName)
+	{
+		NS_LOG_FUNCTION (this << fileName);
+		m_file = fileName;
+		if (fileName.empty ())
+		{
+			SetPoints (m_points);
+			return;
+		}
+		std::ifstream in (fileName.c_str ());
+		NS_ABORT_MSG_IF (!in, "Cannot open rate profile " << fileName);
+		std::vector<std::pair<double, double> > knots;
+		std::string line;
+		while (std::getline (in, line))
+		{
+			if (line.empty () || line[0] == '#')
+			{
+				continue;
+			}
+			double t, m;
+			std::istringstream fields (line);
+			NS_ABORT_MSG_IF (!(fields >> t >> m), "Bad line in " << fileName << ": " << line);
+			knots.push_back (std::make_pair (t, m));
+		}
+		SetKnots (knots);
+	}
+
+	std::string
+	PPBPPiecewiseLinearRateProfile::GetFile () const
+	{
+		return m_file;
+	}
+
+	void
+	PPBPPiecewiseLinearRateProfile::SetKnots (std::vector<std::pair<double, double> > knots)
+	{
+		std::stable_sort (knots.begin (), knots.end ());
+		double peak = 0;
+		for (uint32_t i = 0; i < knots.size (); ++i)
+		{
+			NS_ABORT_MSG_IF (knots[i].second < 0, "Rate profile multipliers must not be negative");
+			peak = std::max (peak, knots[i].second);
+		}
+		// Thinning would otherwise step through zero spans forever when periodic
+		NS_ABORT_MSG_IF (!knots.empty () && peak <= 0, "Rate profile multipliers must not all be zero");
+		m_knots = knots;
+	}
+
+	uint32_t
+	PPBPPiecewiseLinearRateProfile::Find (double t, double &cycle) const
+	{
+		// Index of the last knot at or before t (in the current period), or
+		// the number of knots when t is before the first one
+		double period = m_period.GetSeconds ();
+		cycle = period > 0 ? std::floor (t / period) * period : 0;
+		double tau = t - cycle;
+		std::vector<std::pair<double, double> >::const_iterator i =
+			std::upper_bound (m_knots.begin (), m_knots.end (),
+							  std::make_pair (tau, std::numeric_limits<double>::infinity ()));
+		return i == m_knots.begin () ? m_knots.size () : (i - m_knots.begin ()) - 1;
+	}
+
+	double
+	PPBPPiecewiseLinearRateProfile::GetValue (double t) const
+	{
+		if (m_knots.empty ())
+		{
+			return 1;
+		}
+		double cycle;
+		uint32_t i = Find (t, cycle);
+		if (i == m_knots.size ())
+		{
+			return m_knots.front ().second;
+		}
+		if (i + 1 == m_knots.size ())
+		{
+			return m_knots.back ().second;
+		}
+		const std::pair<double, double> &a = m_knots[i];
+		const std::pair<double, double> &b = m_knots[i + 1];
+		double tau = t - cycle;
+		return a.second + (b.second - a.second) * (tau - a.first) / (b.first - a.first);
+	}
+
+	double
+	PPBPPiecewiseLinearRateProfile::GetBound (double t, double &until) const
+	{
+		const double infinity = std::numeric_limits<double>::infinity ();
+		double period = m_period.GetSeconds ();
+		if (m_knots.empty ())
+		{
+			until = infinity;
+			return 1;
+		}
+		double cycle;
+		uint32_t i = Find (t, cycle);
+		double bound;
+		double end;
+		if (i == m_knots.size ())
+		{
+			bound = m_knots.front ().second;
+			end = m_knots.front ().first;
+		}
+		else if (i + 1 == m_knots.size ())
+		{
+			bound = m_knots.back ().second;
+			end = period > 0 ? period : infinity;
+		}
+		else
+		{
+			bound = std::max (m_knots[i].second, m_knots[i + 1].second);
+			end = m_knots[i + 1].first;
+		}
+		until = cycle + end;
+		if (until <= t)
+		{
+			// Rounding left t at the end of the span; move on by a nanosecond
+			until = t + 1e-9;
+		}
+		return bound;
+	}
+
+	TypeId
+	PPBPSinusoidalRateProfile::GetTypeId (void)
+	{
+		static TypeId tid = TypeId ("ns3::PPBPSinusoidalRateProfile")
+		.SetParent<PPBPRateProfile> ()
+		.AddConstructor<PPBPSinusoidalRateProfile> ()
+		.AddAttribute ("Mean", "Mean multiplier.",
+					   DoubleValue (1),
+					   MakeDoubleAccessor (&PPBPSinusoidalRateProfile::m_mean),
+					   MakeDoubleChecker<double> (0))
+		.AddAttribute ("Amplitude", "Amplitude of the sine; the multiplier is clipped at 0.",
+					   DoubleValue (0.5),
+					   MakeDoubleAccessor (&PPBPSinusoidalRateProfile::m_amplitude),
+					   MakeDoubleChecker<double> ())
+		.AddAttribute ("Period", "Period of the sine, positive.",
+					   TimeValue (Seconds (86400)),
+					   MakeTimeAccessor (&PPBPSinusoidalRateProfile::m_period),
+					   MakeTimeChecker (NanoSeconds (1)))
+		.AddAttribute ("Phase", "Time added to the simulator time.",
+					   TimeValue (Seconds (0)),
+					   MakeTimeAccessor (&PPBPSinusoidalRateProfile::m_phase),
+					   MakeTimeChecker ())
+		;
+		return tid;
+	}
+
+	PPBPSinusoidalRateProfile::PPBPSinusoidalRateProfile ()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		m_mean = 1;
+		m_amplitude = 0.5;
+		m_period = Seconds (86400);
+		m_phase = Seconds (0);
+	}
+
+	double
+	PPBPSinusoidalRateProfile::GetValue (double t) const
+	{
+		double x = 2 * M_PI * (t + m_phase.GetSeconds ()) / m_period.GetSeconds ();
+		return std::max (0.0, m_mean + m_amplitude * std::sin (x));
+	}
+
+	double
+	PPBPSinusoidalRateProfile::GetBound (double t, double &until) const
+	{
+		until = std::numeric_limits<double>::infinity ();
+		return m_mean + std::fabs (m_amplitude);
+	}
+
+} // namespace ns3
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_rate_profile_h__
+#define __PPBP_rate_profile_h__
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Time-varying multiplier of the burst arrival rate.
+	 *
+	 * A PPBPApplication with a RateProfile has bursts arriving as a
+	 * non-homogeneous Poisson process of rate MeanBurstArrivals x m(t).
+	 * The arrivals are drawn by Lewis-Shedler thinning: candidates come at
+	 * the rate of an upper bound of m over a span of time, and each is kept
+	 * with probability m(t) / bound. Profiles only hold their shape, so one
+	 * profile can be shared by any number of applications through a
+	 * PointerValue, and the load follows it without any reconfiguration
+	 * event.
+	 *
+	 * Times are simulator times in seconds.
+	 */
+	class PPBPRateProfile : public Object
+	{
+	public:
+		static TypeId GetTypeId (void);
+
+		virtual ~PPBPRateProfile ();
+
+		/**
+		 * \return the multiplier m(t), at least zero.
+		 */
+		virtual double GetValue (double t) const = 0;
+
+		/**
+		 * \brief Bound the multiplier over a span of time starting at t.
+		 *
+		 * \param t start of the span (s)
+		 * \param until set to the end of the span (s), or infinity
+		 * \return an upper bound of m over [t, until)
+		 */
+		virtual double GetBound (double t, double &until) const = 0;
+	};
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Piecewise-linear rate profile.
+	 *
+	 * The knots (time, multiplier) are given inline as "t:m,t:m,..." or in
+	 * a file of "t m" lines. The multiplier is interpolated linearly between
+	 * knots and held at the first and last values outside them. With a
+	 * Period, the knots describe [0, Period) and repeat, e.g. 24 hourly
+	 * values over a day. The thinning bound is the larger end of the
+	 * current segment, so it stays tight however the profile varies.
+	 * Multipliers must not be negative, and at least one must be positive.
+	 */
+	class PPBPPiecewiseLinearRateProfile : public PPBPRateProfile
+	{
+	public:
+		static TypeId GetTypeId (void);
+
+		PPBPPiecewiseLinearRateProfile ();
+
+		virtual double GetValue (double t) const;
+		virtual double GetBound (double t, double &until) const;
+
+	private:
+		void SetPoints (std::string points);
+		std::string GetPoints () const;
+		void SetFile (std::string fileName);
+		std::string GetFile () const;
+		void SetKnots (std::vector<std::pair<double, double> > knots);
+		uint32_t Find (double t, double &cycle) const;
+
+		std::string		m_points;						// Points attribute
+		std::string		m_file;							// File attribute
+		Time			m_period;						// Repeat period, zero for none
+		std::vector<std::pair<double, double> >	m_knots;	// (time, multiplier) by time
+	};
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Periodic rate profile m(t) = Mean + Amplitude sin(2 pi (t + Phase) / Period),
+	 *        e.g. a diurnal load.
+	 */
+	class PPBPSinusoidalRateProfile : public PPBPRateProfile
+	{
+	public:
+		static TypeId GetTypeId (void);
+
+		PPBPSinusoidalRateProfile ();
+
+		virtual double GetValue (double t) const;
+		virtual double GetBound (double t, double &until) const;
+
+	private:
+		double			m_mean;							// Mean multiplier
+		double			m_amplitude;					// Amplitude of the sine
+		Time			m_period;						// Period of the sine
+		Time			m_phase;						// Time added to t
+	};
+
+} // namespace ns3
+#endif
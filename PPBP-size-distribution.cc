@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-size-distribution.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <fstream>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPSizeDistribution");
+
+namespace ns3 {
+
+	PPBPSizeDistribution::PPBPSizeDistribution ()
+		: m_mean (0)
+	{
+	}
+
+	void
+	PPBPSizeDistribution::Parse (std::string spec)
+	{
+		std::vector<uint32_t> sizes;
+		std::vector<double> weights;
+		std::istringstream in (spec);
+		std::string item;
+		while (std::getline (in, item, ','))
+		{
+			uint32_t size;
+			char colon;
+			double weight;
+			std::istringstream fields (item);
+			NS_ABORT_MSG_IF (!(fields >> size >> colon >> weight) || colon != ':',
+							 "Bad packet size \"" << item << "\", expected size:weight");
+			sizes.push_back (size);
+			weights.push_back (weight);
+		}
+		Set (sizes, weights);
+	}
+
+	void
+	PPBPSizeDistribution::Load (std::string fileName)
+	{
+		std::ifstream in (fileName.c_str ());
+		NS_ABORT_MSG_IF (!in, "Cannot open packet size file " << fileName);
+		std::vector<uint32_t> sizes;
+		std::vector<double> weights;
+		std::string line;
+		while (std::getline (in, line))
+		{
+			if (line.empty () || line[0] == '#')
+			{
+				continue;
+			}
+			uint32_t size;
+			double weight;
+			std::istringstream fields (line);
+			NS_ABORT_MSG_IF (!(fields >> size >> weight), "Bad line in " << fileName << ": " << line);
+			sizes.push_back (size);
+			weights.push_back (weight);
+		}
+		Set (sizes, weights);
+	}
+
+	void
+	PPBPSizeDistribution::Set (const std::vector<uint32_t> &sizes, const std::vector<double> &weights)
+	{
+		NS_ABORT_MSG_IF (sizes.size () != weights.size (), "One weight per packet size is needed");
+		m_sizes = sizes;
+		m_prob.clear ();
+		m_alias.clear ();
+		m_mean = 0;
+		if (sizes.empty ())
+		{
+			return;
+		}
+
+		double total = 0;
+		for (uint32_t i = 0; i < sizes.size (); ++i)
+		{
+			NS_ABORT_MSG_IF (weights[i] < 0 || sizes[i] == 0, "Packet sizes and weights must be positive");
+			total += weights[i];
+		}
+		NS_ABORT_MSG_IF (total <= 0, "Packet size weights sum to zero");
+
+		// Vose: pair every column below the average with one above it
+		uint32_t n = sizes.size ();
+		m_prob.resize (n);
+		m_alias.resize (n);
+		std::vector<double> scaled (n);
+		std::vector<uint32_t> small, large;
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			m_mean += sizes[i] * weights[i] / total;
+			scaled[i] = weights[i] * n / total;
+			(scaled[i] < 1 ? small : large).push_back (i);
+		}
+		while (!small.empty () && !large.empty ())
+		{
+			uint32_t s = small.back ();
+			uint32_t l = large.back ();
+			small.pop_back ();
+			m_prob[s] = scaled[s];
+			m_alias[s] = l;
+			scaled[l] -= 1 - scaled[s];
+			if (scaled[l] < 1)
+			{
+				large.pop_back ();
+				small.push_back (l);
+			}
+		}
+		// What is left is 1 up to rounding
+		for (uint32_t i = 0; i < large.size (); ++i)
+		{
+			m_prob[large[i]] = 1;
+			m_alias[large[i]] = large[i];
+		}
+		for (uint32_t i = 0; i < small.size (); ++i)
+		{
+			m_prob[small[i]] = 1;
+			m_alias[small[i]] = small[i];
+		}
+		NS_LOG_INFO (n << " packet sizes, mean " << m_mean << " bytes");
+	}
+
+	bool
+	PPBPSizeDistribution::IsEmpty () const
+	{
+		return m_sizes.empty ();
+	}
+
+	uint32_t
+	PPBPSizeDistribution::GetN () const
+	{
+		return m_sizes.size ();
+	}
+
+	uint32_t
+	PPBPSizeDistribution::GetSize (uint32_t i) const
+	{
+		return m_sizes[i];
+	}
+
+	double
+	PPBPSizeDistribution::GetMean () const
+	{
+		return m_mean;
+	}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_size_distribution_h__
+#define __PPBP_size_distribution_h__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Empirical packet-size distribution sampled with an alias table.
+	 *
+	 * The distribution is a set of sizes with relative weights, given inline
+	 * as "size:weight,size:weight,..." (e.g. IMIX "40:7,576:4,1500:1") or
+	 * read from a file with one "size weight" pair per line. Walker's alias
+	 * table is built once (Vose's construction, linear in the number of
+	 * sizes), after which every sample costs one uniform, one comparison and
+	 * at most two table reads whatever the number of sizes.
+	 */
+	class PPBPSizeDistribution
+	{
+	public:
+		PPBPSizeDistribution ();
+
+		/**
+		 * \brief Set the distribution from "size:weight,..."; an empty string
+		 * clears it.
+		 */
+		void Parse (std::string spec);
+
+		/**
+		 * \brief Set the distribution from a file of "size weight" lines;
+		 * empty lines and lines starting with '#' are skipped.
+		 */
+		void Load (std::string fileName);
+
+		/**
+		 * \brief Set the distribution and build its alias table.
+		 */
+		void Set (const std::vector<uint32_t> &sizes, const std::vector<double> &weights);
+
+		bool IsEmpty () const;
+
+		/**
+		 * \return the number of sizes.
+		 */
+		uint32_t GetN () const;
+
+		/**
+		 * \return the size of class i.
+		 */
+		uint32_t GetSize (uint32_t i) const;
+
+		/**
+		 * \return the mean size.
+		 */
+		double GetMean () const;
+
+		/**
+		 * \return the class drawn by the uniform u in [0, 1).
+		 */
+		uint32_t Sample (double u) const
+		{
+			double x = u * m_prob.size ();
+			uint32_t i = (uint32_t) x;
+			if (i >= m_prob.size ())
+			{
+				i = m_prob.size () - 1;
+			}
+			return x - i < m_prob[i] ? i : m_alias[i];
+		}
+
+	private:
+		std::vector<uint32_t>	m_sizes;			// Size of each class
+		std::vector<double>		m_prob;				// Probability of keeping column i
+		std::vector<uint32_t>	m_alias;			// Class taken otherwise
+		double					m_mean;				// Mean size
+	};
+
+} // namespace ns3
+#endif
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This script checks the empirical packet sizes of PPBPApplication
+*  (PacketSizeDistribution, IMIX by default). It first samples the alias
+*  table of PPBPSizeDistribution directly and compares the frequency of
+*  every size with its weight, within the given number of standard errors.
+*  It then runs a PPBP source with the distribution and checks:
+*  - the frequency of every size among the packets sent, likewise;
+*  - that the bits sent, headers (HeaderOverhead) included, match the
+*    BurstIntensity of the bursts that were active, i.e. the integral of
+*    ActiveBursts x BurstIntensity, within the given relative tolerance.
+*  The packets go to an address without a route, so no link limits them.
+*  The program fails if any check is out of tolerance.
+*  Example run: Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-size-test --sizes=40:7,576:4,1500:1"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "PPBP-check.h"
+#include <cmath>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPSizeTest");
+
+static std::map<uint32_t, uint64_t> g_sent;          // Packets sent, by size
+static double g_bits = 0;                             // Bits sent, headers included
+static uint32_t g_overhead = 30;
+static uint32_t g_active = 0;
+static Time g_last;
+static double g_burstSeconds = 0;                     // Integral of the active bursts
+
+static void
+CountTx (Ptr<const Packet> packet)
+{
+  ++g_sent[packet->GetSize ()];
+  g_bits += (packet->GetSize () + g_overhead) * 8.0;
+}
+
+static void
+CountBursts (uint32_t oldValue, uint32_t newValue)
+{
+  g_burstSeconds += g_active * (Simulator::Now () - g_last).GetSeconds ();
+  g_active = newValue;
+  g_last = Simulator::Now ();
+}
+
+static void
+CheckFrequencies (std::string what, const std::map<uint32_t, uint64_t> &counts,
+                  const std::map<uint32_t, double> &weights, double sigmas)
+{
+  double total = 0;
+  double n = 0;
+  for (std::map<uint32_t, double>::const_iterator i = weights.begin (); i != weights.end (); ++i)
+    {
+      total += i->second;
+    }
+  for (std::map<uint32_t, uint64_t>::const_iterator i = counts.begin (); i != counts.end (); ++i)
+    {
+      n += i->second;
+    }
+  for (std::map<uint32_t, double>::const_iterator i = weights.begin (); i != weights.end (); ++i)
+    {
+      double p = i->second / total;
+      std::map<uint32_t, uint64_t>::const_iterator c = counts.find (i->first);
+      double frequency = c == counts.end () ? 0 : c->second / n;
+      std::ostringstream name;
+      name << what << " frequency of " << i->first << " bytes";
+      PPBPCheck (name.str (), frequency, p, sigmas * std::sqrt (p * (1 - p) / n));
+    }
+  bool unknown = false;
+  for (std::map<uint32_t, uint64_t>::const_iterator i = counts.begin (); i != counts.end (); ++i)
+    {
+      unknown = unknown || !weights.count (i->first);
+    }
+  PPBPCheck (what + " packets of sizes not in the distribution", unknown, 0, 0);
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string sizes = "40:7,576:4,1500:1";
+  uint32_t draws = 1000000;
+  double simulationTime = 100; //seconds
+  double burstArrivals = 20;
+  double burstLength = 0.2;
+  std::string burstIntensity = "10Mb/s";
+  double sigmas = 5;
+  double tolerance = 0.01;
+
+  CommandLine cmd;
+  cmd.AddValue ("sizes", "Packet sizes and weights, as size:weight,...", sizes);
+  cmd.AddValue ("draws", "Sizes drawn from the alias table", draws);
+  cmd.AddValue ("simulationTime", "Simulated time of the PPBP source (s)", simulationTime);
+  cmd.AddValue ("burstArrivals", "Mean rate of burst arrivals (1/s)", burstArrivals);
+  cmd.AddValue ("burstLength", "Mean burst time length (s)", burstLength);
+  cmd.AddValue ("burstIntensity", "Data rate of each burst", burstIntensity);
+  cmd.AddValue ("overhead", "HeaderOverhead of the source (bytes)", g_overhead);
+  cmd.AddValue ("sigmas", "Tolerance of the frequencies in standard errors", sigmas);
+  cmd.AddValue ("tolerance", "Relative tolerance of the bits sent", tolerance);
+  cmd.Parse (argc, argv);
+
+  Time::SetResolution (Time::NS);
+
+  // Weights by size, added up if a size is listed twice
+  std::map<uint32_t, double> weights;
+  std::istringstream list (sizes);
+  std::string item;
+  while (std::getline (list, item, ','))
+    {
+      uint32_t size;
+      double weight;
+      char colon;
+      std::istringstream fields (item);
+      NS_ABORT_MSG_IF (!(fields >> size >> colon >> weight) || colon != ':', "Bad size \"" << item << "\"");
+      weights[size] += weight;
+    }
+
+  NS_LOG_UNCOND ("Alias table, " << draws << " draws");
+  PPBPSizeDistribution distribution;
+  distribution.Parse (sizes);
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (0);
+  std::map<uint32_t, uint64_t> drawn;
+  for (uint32_t i = 0; i < draws; ++i)
+    {
+      ++drawn[distribution.GetSize (distribution.Sample (uniform->GetValue ()))];
+    }
+  CheckFrequencies ("table", drawn, weights, sigmas);
+
+  NS_LOG_UNCOND ("PPBP source, " << simulationTime << " s");
+  NodeContainer nodes;
+  nodes.Create (1);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  PPBPHelper ppbp = PPBPHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address ("10.1.1.2"), 9));
+  ppbp.SetAttribute ("PacketSizeDistribution", StringValue (sizes));
+  ppbp.SetAttribute ("HeaderOverhead", UintegerValue (g_overhead));
+  ppbp.SetAttribute ("BurstIntensity", DataRateValue (DataRate (burstIntensity)));
+  std::ostringstream arrivals;
+  arrivals << "ns3::ConstantRandomVariable[Constant=" << burstArrivals << "]";
+  ppbp.SetAttribute ("MeanBurstArrivals", StringValue (arrivals.str ()));
+  std::ostringstream length;
+  length << "ns3::ConstantRandomVariable[Constant=" << burstLength << "]";
+  ppbp.SetAttribute ("MeanBurstTimeLength", StringValue (length.str ()));
+  ApplicationContainer apps = ppbp.Install (nodes.Get (0));
+  ppbp.AssignStreams (nodes, 1);
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (simulationTime));
+  apps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&CountTx));
+  apps.Get (0)->TraceConnectWithoutContext ("ActiveBursts", MakeCallback (&CountBursts));
+
+  Simulator::Stop (Seconds (simulationTime));
+  Simulator::Run ();
+  CountBursts (g_active, g_active);
+  Simulator::Destroy ();
+
+  CheckFrequencies ("sent", g_sent, weights, sigmas);
+  double expected = g_burstSeconds * DataRate (burstIntensity).GetBitRate ();
+  PPBPCheck ("bits sent / bits of the active bursts", g_bits / expected, 1, tolerance);
+
+  return PPBPCheckSummary ();
+}
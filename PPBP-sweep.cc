@@ -0,0 +1,360 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This script runs a parameter sweep of PPBP experiments in parallel.
+*  The configurations are the grid of the comma-separated lists of H,
+*  burstArrivals, burstLength, burstIntensity and packetSize, or the lines
+*  of a file (--configs) with these five values each. Every configuration is
+*  run in a child process of its own, at most jobs at a time, with the RNG
+*  run number runBase + its index. One PPBP source sends across a
+*  point-to-point link of linkRate to a sink, and each run appends a line
+*  to the results CSV with the expected and the realized mean rate, the
+*  throughput at the sink and the packets dropped on the way. The link has
+*  no queue disc, so the drops are those of the device queue and channel,
+*  as counted by the device traces; packets still in flight at the end are
+*  neither received nor dropped.
+*  Runs already in the results file are skipped, so an interrupted sweep is
+*  resumed by running the same command again; --restart=true starts over.
+*  A run counts as done only if its whole configuration (run number, the
+*  five parameters, simulationTime and linkRate) matches; a results file
+*  holding runs of another sweep is refused rather than extended.
+*  Example run: Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-sweep --H=0.6,0.7,0.8,0.9 --burstArrivals=10,20 --jobs=8"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPSweep");
+
+static uint64_t g_rxPackets = 0;
+static uint64_t g_drops = 0;
+
+static void
+CountRx (Ptr<const Packet> packet, const Address &from)
+{
+  ++g_rxPackets;
+}
+
+static void
+CountDrop (Ptr<const Packet> packet)
+{
+  ++g_drops;
+}
+
+template <typename T>
+static std::vector<T>
+SplitList (std::string list)
+{
+  std::vector<T> values;
+  std::istringstream in (list);
+  std::string item;
+  while (std::getline (in, item, ','))
+    {
+      std::istringstream value (item);
+      T v;
+      value >> v;
+      values.push_back (v);
+    }
+  return values;
+}
+
+struct SweepPoint
+{
+  uint32_t run;
+  double hurst;
+  double burstArrivals;
+  double burstLength;
+  std::string burstIntensity;
+  uint32_t packetSize;
+};
+
+// Leading columns of a result line, which identify the run on resume
+static std::string
+GetKey (const SweepPoint &p, double simulationTime, std::string linkRate)
+{
+  std::ostringstream key;
+  key << p.run << "," << p.hurst << "," << p.burstArrivals << "," << p.burstLength << ","
+      << p.burstIntensity << "," << p.packetSize << "," << simulationTime << "," << linkRate;
+  return key.str ();
+}
+
+static const uint32_t g_keyColumns = 8;
+
+static std::string
+RunPoint (const SweepPoint &p, double simulationTime, std::string linkRate)
+{
+  RngSeedManager::SetRun (p.run);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (linkRate));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  // Leave the device queue as the only queue, so that its drop traces see
+  // every packet lost on the way
+  TrafficControlHelper tch;
+  tch.Uninstall (devices);
+  devices.Get (0)->TraceConnectWithoutContext ("MacTxDrop", MakeCallback (&CountDrop));
+  devices.Get (0)->TraceConnectWithoutContext ("PhyTxDrop", MakeCallback (&CountDrop));
+  devices.Get (1)->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&CountDrop));
+
+  uint32_t socketPort = 9;
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), socketPort));
+  Ptr<PacketSink> sink = DynamicCast<PacketSink> (sinkHelper.Install (nodes.Get (1)).Get (0));
+  sink->TraceConnectWithoutContext ("Rx", MakeCallback (&CountRx));
+
+  PPBPHelper ppbp = PPBPHelper ("ns3::UdpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), socketPort));
+  ppbp.SetAttribute ("H", DoubleValue (p.hurst));
+  ppbp.SetAttribute ("BurstIntensity", DataRateValue (DataRate (p.burstIntensity)));
+  ppbp.SetAttribute ("PacketSize", UintegerValue (p.packetSize));
+  std::ostringstream arrivals;
+  arrivals << "ns3::ConstantRandomVariable[Constant=" << p.burstArrivals << "]";
+  ppbp.SetAttribute ("MeanBurstArrivals", StringValue (arrivals.str ()));
+  std::ostringstream length;
+  length << "ns3::ConstantRandomVariable[Constant=" << p.burstLength << "]";
+  ppbp.SetAttribute ("MeanBurstTimeLength", StringValue (length.str ()));
+  ApplicationContainer apps = ppbp.Install (nodes.Get (0));
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (simulationTime));
+
+  Simulator::Stop (Seconds (simulationTime));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  Ptr<PPBPApplication> app = DynamicCast<PPBPApplication> (apps.Get (0));
+  double expected = p.burstArrivals * p.burstLength * DataRate (p.burstIntensity).GetBitRate ();
+  uint64_t sent = app->GetTotalPackets ();
+  std::ostringstream line;
+  line << GetKey (p, simulationTime, linkRate) << ","
+       << expected << "," << app->GetTotalBytes () * 8 / simulationTime << ","
+       << sink->GetTotalRx () * 8 / simulationTime << "," << sent << "," << g_rxPackets << ","
+       << g_drops << "," << wall << "\n";
+  Simulator::Destroy ();
+  return line.str ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  double simulationTime = 60; //seconds
+  std::string output = "ppbp-sweep.csv";
+  std::string configs = "";
+  std::string linkRate = "100Mbps";
+  uint32_t jobs = sysconf (_SC_NPROCESSORS_ONLN);
+  uint32_t runBase = 1;
+  bool restart = false;
+  std::string hurstList = "0.7";
+  std::string arrivalsList = "20";
+  std::string lengthList = "0.2";
+  std::string intensityList = "1Mb/s";
+  std::string sizeList = "1470";
+
+  CommandLine cmd;
+  cmd.AddValue ("simulationTime", "Simulated time of each run (s)", simulationTime);
+  cmd.AddValue ("output", "Results CSV file", output);
+  cmd.AddValue ("configs", "File of configurations: H burstArrivals burstLength burstIntensity packetSize per line", configs);
+  cmd.AddValue ("linkRate", "Data rate of the link to the sink", linkRate);
+  cmd.AddValue ("jobs", "Runs in parallel", jobs);
+  cmd.AddValue ("runBase", "RNG run number of the first configuration", runBase);
+  cmd.AddValue ("restart", "Discard the results of a previous sweep", restart);
+  cmd.AddValue ("H", "Hurst parameters", hurstList);
+  cmd.AddValue ("burstArrivals", "Mean rates of burst arrivals (1/s)", arrivalsList);
+  cmd.AddValue ("burstLength", "Mean burst time lengths (s)", lengthList);
+  cmd.AddValue ("burstIntensity", "Data rates of each burst", intensityList);
+  cmd.AddValue ("packetSize", "Packet sizes (bytes)", sizeList);
+  cmd.Parse (argc, argv);
+
+  Time::SetResolution (Time::NS);
+  jobs = std::max<uint32_t> (jobs, 1);
+
+  std::vector<SweepPoint> points;
+  if (!configs.empty ())
+    {
+      std::ifstream in (configs.c_str ());
+      NS_ABORT_MSG_IF (!in, "Cannot open " << configs);
+      std::string text;
+      while (std::getline (in, text))
+        {
+          if (text.empty () || text[0] == '#')
+            {
+              continue;
+            }
+          std::istringstream fields (text);
+          SweepPoint p;
+          NS_ABORT_MSG_IF (!(fields >> p.hurst >> p.burstArrivals >> p.burstLength >> p.burstIntensity >> p.packetSize),
+                           "Bad configuration: " << text);
+          p.run = runBase + points.size ();
+          points.push_back (p);
+        }
+    }
+  else
+    {
+      std::vector<double> hurst = SplitList<double> (hurstList);
+      std::vector<double> arrivals = SplitList<double> (arrivalsList);
+      std::vector<double> length = SplitList<double> (lengthList);
+      std::vector<std::string> intensity = SplitList<std::string> (intensityList);
+      std::vector<uint32_t> size = SplitList<uint32_t> (sizeList);
+      for (uint32_t h = 0; h < hurst.size (); ++h)
+        for (uint32_t l = 0; l < arrivals.size (); ++l)
+          for (uint32_t t = 0; t < length.size (); ++t)
+            for (uint32_t r = 0; r < intensity.size (); ++r)
+              for (uint32_t s = 0; s < size.size (); ++s)
+                {
+                  SweepPoint p;
+                  p.hurst = hurst[h];
+                  p.burstArrivals = arrivals[l];
+                  p.burstLength = length[t];
+                  p.burstIntensity = intensity[r];
+                  p.packetSize = size[s];
+                  p.run = runBase + points.size ();
+                  points.push_back (p);
+                }
+    }
+
+  // Runs already done by an interrupted sweep, by their configuration
+  std::set<std::string> keys;
+  for (uint32_t i = 0; i < points.size (); ++i)
+    {
+      keys.insert (GetKey (points[i], simulationTime, linkRate));
+    }
+  std::set<std::string> done;
+  std::ifstream previous (restart ? "" : output.c_str ());
+  std::string text;
+  while (std::getline (previous, text))
+    {
+      uint32_t run;
+      if (!(std::istringstream (text) >> run))
+        {
+          continue;                             // Header
+        }
+      std::string::size_type end = 0;
+      for (uint32_t c = 0; c < g_keyColumns && end != std::string::npos; ++c)
+        {
+          end = text.find (',', end + (c > 0));
+        }
+      std::string key = text.substr (0, end);
+      NS_ABORT_MSG_IF (!keys.count (key), output << " holds a run of another sweep (" << key
+                       << "); use --restart=true or another --output");
+      done.insert (key);
+    }
+  previous.close ();
+  std::ofstream csv;
+  if (restart || done.empty ())
+    {
+      csv.open (output.c_str (), std::ios::trunc);
+      csv << "run,H,burstArrivals,burstLength,burstIntensity,packetSize,simulationTime,linkRate,"
+          << "expectedRate,sentRate,throughput,sentPackets,receivedPackets,drops,wallSeconds" << std::endl;
+    }
+  else
+    {
+      csv.open (output.c_str (), std::ios::app);
+      NS_LOG_UNCOND ("Resuming: " << done.size () << " runs already in " << output);
+    }
+
+  // Every child writes its result line to a pipe read by the parent, which
+  // alone appends to the results file
+  std::map<pid_t, std::pair<uint32_t, int> > running;
+  uint32_t next = 0;
+  uint32_t failed = 0;
+  while (next < points.size () || !running.empty ())
+    {
+      while (next < points.size () && running.size () < jobs)
+        {
+          const SweepPoint &p = points[next++];
+          if (done.count (GetKey (p, simulationTime, linkRate)))
+            {
+              continue;
+            }
+          int fds[2];
+          NS_ABORT_MSG_IF (pipe (fds) != 0, "pipe failed");
+          std::fflush (stdout);
+          pid_t pid = fork ();
+          if (pid == 0)
+            {
+              close (fds[0]);
+              std::string line = RunPoint (p, simulationTime, linkRate);
+              ssize_t written = write (fds[1], line.data (), line.size ());
+              _exit (written == (ssize_t) line.size () ? 0 : 1);
+            }
+          close (fds[1]);
+          NS_ABORT_MSG_IF (pid < 0, "fork failed");
+          running[pid] = std::make_pair (p.run, fds[0]);
+          NS_LOG_UNCOND ("run " << p.run << ": H=" << p.hurst << " burstArrivals=" << p.burstArrivals
+                         << " burstLength=" << p.burstLength << " burstIntensity=" << p.burstIntensity
+                         << " packetSize=" << p.packetSize);
+        }
+      if (running.empty ())
+        {
+          break;
+        }
+
+      int status = 0;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0 || !running.count (pid))
+        {
+          continue;
+        }
+      uint32_t run = running[pid].first;
+      int fd = running[pid].second;
+      running.erase (pid);
+      std::string line;
+      char buffer[512];
+      ssize_t n;
+      while ((n = read (fd, buffer, sizeof (buffer))) > 0)
+        {
+          line.append (buffer, n);
+        }
+      close (fd);
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0 && !line.empty ())
+        {
+          csv << line << std::flush;
+        }
+      else
+        {
+          ++failed;
+          NS_LOG_UNCOND ("  run " << run << " failed; it is retried on resume");
+        }
+    }
+
+  NS_LOG_UNCOND ("Wrote " << output << (failed ? ", with failed runs" : ""));
+  return failed ? 1 : 0;
+}
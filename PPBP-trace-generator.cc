@@ -0,0 +1,364 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-trace-generator.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/abort.h"
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPTraceGenerator");
+
+namespace ns3 {
+
+	NS_OBJECT_ENSURE_REGISTERED (PPBPTraceGenerator);
+
+	TypeId
+	PPBPTraceGenerator::GetTypeId (void)
+	{
+		static TypeId tid = TypeId ("ns3::PPBPTraceGenerator")
+		.SetParent<Object> ()
+		.AddConstructor<PPBPTraceGenerator> ()
+		.AddAttribute ("BurstIntensity", "The data rate of each burst.",
+					   DataRateValue (DataRate ("1Mb/s")),
+					   MakeDataRateAccessor (&PPBPTraceGenerator::m_cbrRate),
+					   MakeDataRateChecker ())
+		.AddAttribute ("PacketSize", "The size of packets sent in on state",
+					   UintegerValue (1470),
+					   MakeUintegerAccessor (&PPBPTraceGenerator::m_pktSize),
+					   MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("HeaderOverhead", "Bytes of lower-layer headers added to each packet "
+					   "when pacing the bursts.",
+					   UintegerValue (30),
+					   MakeUintegerAccessor (&PPBPTraceGenerator::m_headerOverhead),
+					   MakeUintegerChecker<uint32_t> ())
+		.AddAttribute ("MeanBurstArrivals", "Mean Active Sources",
+					   StringValue ("ns3::ConstantRandomVariable[Constant=20.0]"),
+					   MakePointerAccessor (&PPBPTraceGenerator::m_burstArrivals),
+					   MakePointerChecker <RandomVariableStream>())
+		.AddAttribute ("MeanBurstTimeLength", "Mean burst duration",
+					   StringValue ("ns3::ConstantRandomVariable[Constant=0.2]"),
+					   MakePointerAccessor (&PPBPTraceGenerator::m_burstLength),
+					   MakePointerChecker <RandomVariableStream>())
+		.AddAttribute ("MaxBurstLength", "Upper bound of the burst lengths, 0 for none. The "
+					   "Pareto scale is raised so that the mean burst length is kept.",
+					   TimeValue (Seconds (0)),
+					   MakeTimeAccessor (&PPBPTraceGenerator::m_maxBurstLength),
+					   MakeTimeChecker ())
+		.AddAttribute ("StationaryStart", "Start with the active bursts of the steady state "
+					   "instead of none.",
+					   BooleanValue (false),
+					   MakeBooleanAccessor (&PPBPTraceGenerator::m_stationaryStart),
+					   MakeBooleanChecker ())
+		.AddAttribute ("H", "Hurst parameter",
+					   DoubleValue (0.7),
+					   MakeDoubleAccessor (&PPBPTraceGenerator::SetHurst,
+										   &PPBPTraceGenerator::GetHurst),
+					   MakeDoubleChecker<double> ())
+		;
+		return tid;
+	}
+
+	PPBPTraceGenerator::PPBPTraceGenerator ()
+		: m_engine (Arrivals (this), Lengths (this), PPBPFixedSize (), Sink ())
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		m_boundedMean = 0;
+		m_boundedShape = 0;
+		m_boundedScale = 0;
+		m_stationaryStart = false;
+		m_mean = 0;
+		m_timeSlot = 0;
+		m_arrivalVariate = CreateObject<ExponentialRandomVariable> ();
+		m_lengthVariate = CreateObject<ParetoRandomVariable> ();
+	}
+
+	PPBPTraceGenerator::~PPBPTraceGenerator()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+	}
+
+	void
+	PPBPTraceGenerator::DoDispose (void)
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		m_arrivalVariate = 0;
+		m_lengthVariate = 0;
+		Object::DoDispose ();
+	}
+
+	int64_t
+	PPBPTraceGenerator::AssignStreams (int64_t stream)
+	{
+		NS_LOG_FUNCTION (this << stream);
+		// Same layout as the first four streams of PPBPApplication::AssignStreams ()
+		m_burstArrivals->SetStream (stream);
+		m_burstLength->SetStream (stream + 1);
+		m_arrivalVariate->SetStream (stream + 2);
+		m_lengthVariate->SetStream (stream + 3);
+		return 4;
+	}
+
+	void
+	PPBPTraceGenerator::SetHurst (double h)
+	{
+		NS_LOG_FUNCTION (this << h);
+		m_h = h;
+		m_shape = 3 - 2 * m_h;
+	}
+
+	double
+	PPBPTraceGenerator::GetHurst () const
+	{
+		return m_h;
+	}
+
+	uint64_t
+	PPBPTraceGenerator::Generate (Time duration, PPBPTraceWriter &writer, uint32_t source)
+	{
+		NS_LOG_FUNCTION (this << duration << source);
+
+		// Same start-up as PPBPApplication::StartSending ()
+		Sink &sink = m_engine.GetSink ();
+		sink.writer = &writer;
+		sink.source = source;
+		sink.size = m_pktSize;
+		sink.packets = 0;
+		m_engine.GetPacer ().SetPacketBits ((m_pktSize + m_headerOverhead) * 8, Seconds (1).GetTimeStep ());
+		m_engine.GetPacer ().SetBurstRate (m_cbrRate.GetBitRate ());
+		m_engine.Reset (0);
+		m_engine.DrawArrival (0);
+		if (m_stationaryStart)
+		{
+			StationaryStart ();
+		}
+		m_engine.Update (0);
+
+		m_engine.Run (duration.GetTimeStep ());
+		return sink.packets;
+	}
+
+	Time
+	PPBPTraceGenerator::DrawArrival (Time now)
+	{
+		double inter_burst_intervals = (double) 1/m_burstArrivals->GetValue ();
+		return now + Seconds (m_arrivalVariate->GetValue (inter_burst_intervals, 0));
+	}
+
+	Time
+	PPBPTraceGenerator::DrawBurstLength ()
+	{
+		m_mean = m_burstLength->GetValue ();
+		double mean = m_mean;
+		double bound = m_maxBurstLength.GetSeconds ();
+		double timeSlot = (double) (m_shape - 1) * mean / m_shape;
+		if (bound > 0)
+		{
+			if (mean != m_boundedMean || m_shape != m_boundedShape)
+			{
+				NS_ABORT_MSG_IF (mean >= bound, "MaxBurstLength must exceed the mean burst length");
+				m_boundedMean = mean;
+				m_boundedShape = m_shape;
+				m_boundedScale = PPBPVariateBuffer::GetBoundedParetoScale (mean, m_shape, bound);
+			}
+			timeSlot = m_boundedScale;
+		}
+		m_timeSlot = timeSlot;
+		return Seconds (m_lengthVariate->GetValue (timeSlot, m_shape, bound));
+	}
+
+	void
+	PPBPTraceGenerator::StationaryStart ()
+	{
+		// Same draws as PPBPApplication::StationaryStart ()
+		double bound = m_maxBurstLength.GetSeconds ();
+		NS_ABORT_MSG_IF (m_shape <= 1 && bound <= 0, "StationaryStart needs H < 1 or a MaxBurstLength");
+		double mean = m_burstArrivals->GetValue () * m_mean;
+		double sum = m_arrivalVariate->GetValue (1, 0);
+		while (sum <= mean)
+		{
+			double u1 = std::exp (-m_arrivalVariate->GetValue (1, 0));
+			double u2 = std::exp (-m_arrivalVariate->GetValue (1, 0));
+			Time length = Seconds (PPBPVariateBuffer::GetResidualPareto (m_timeSlot, m_shape, bound, u1, u2));
+			m_engine.AddBurst (length.GetTimeStep (), length.GetTimeStep (), 0);
+			sum += m_arrivalVariate->GetValue (1, 0);
+		}
+	}
+
+	PPBPParallelTraceGenerator::PPBPParallelTraceGenerator ()
+	{
+		m_factory.SetTypeId ("ns3::PPBPTraceGenerator");
+	}
+
+	void
+	PPBPParallelTraceGenerator::SetAttribute (std::string name, const AttributeValue &value)
+	{
+		m_factory.Set (name, value);
+	}
+
+	std::string
+	PPBPParallelTraceGenerator::GetPartName (std::string output, uint32_t source)
+	{
+		std::ostringstream oss;
+		oss << output << ".part" << source;
+		return oss.str ();
+	}
+
+	void
+	PPBPParallelTraceGenerator::RemoveParts (std::string output, uint32_t sources)
+	{
+		for (uint32_t i = 0; i < sources; ++i)
+		{
+			remove (GetPartName (output, i).c_str ());
+		}
+	}
+
+	namespace {
+
+		// Head of one part file in the k-way merge
+		struct MergeEntry
+		{
+			uint64_t	timeNs;
+			uint32_t	source;
+
+			bool operator> (const MergeEntry &o) const
+			{
+				return timeNs > o.timeNs || (timeNs == o.timeNs && source > o.source);
+			}
+		};
+
+	} // anonymous namespace
+
+	uint64_t
+	PPBPParallelTraceGenerator::Generate (uint32_t sources, Time duration, int64_t stream,
+										  uint32_t threads, std::string output)
+	{
+		NS_LOG_FUNCTION (this << sources << duration << stream << threads << output);
+
+		std::vector<Ptr<PPBPTraceGenerator> > generators (sources);
+		for (uint32_t i = 0; i < sources; ++i)
+		{
+			generators[i] = m_factory.Create<PPBPTraceGenerator> ();
+			generators[i]->AssignStreams (stream + 4 * (int64_t) i);
+		}
+
+		if (threads == 0)
+		{
+			threads = std::max (1u, std::thread::hardware_concurrency ());
+		}
+		threads = std::min (threads, std::max (sources, 1u));
+
+		// Each worker takes the next source not yet generated
+		std::atomic<uint32_t> nextSource (0);
+		std::atomic<bool> failed (false);
+		std::vector<std::thread> workers;
+		for (uint32_t t = 0; t < threads; ++t)
+		{
+			workers.push_back (std::thread ([&] ()
+			{
+				uint32_t i;
+				while ((i = nextSource++) < sources)
+				{
+					PPBPTraceWriter writer;
+					if (!writer.Open (GetPartName (output, i)))
+					{
+						failed = true;
+						return;
+					}
+					generators[i]->Generate (duration, writer, i);
+					if (!writer.Close (duration.GetNanoSeconds ()))
+					{
+						failed = true;
+						return;
+					}
+				}
+			}));
+		}
+		for (uint32_t t = 0; t < threads; ++t)
+		{
+			workers[t].join ();
+		}
+		generators.clear ();
+		if (failed)
+		{
+			RemoveParts (output, sources);
+			NS_ABORT_MSG ("Cannot write the part files of " << output);
+		}
+
+		// k-way merge of the time-ordered part files
+		std::vector<PPBPTraceReader *> readers (sources);
+		std::priority_queue<MergeEntry, std::vector<MergeEntry>, std::greater<MergeEntry> > heads;
+		for (uint32_t i = 0; i < sources; ++i)
+		{
+			readers[i] = new PPBPTraceReader ();
+			if (!readers[i]->Open (GetPartName (output, i)))
+			{
+				RemoveParts (output, sources);
+				NS_ABORT_MSG ("Cannot read back " << GetPartName (output, i));
+			}
+			const PPBPTraceRecord *record = readers[i]->Peek ();
+			if (record)
+			{
+				MergeEntry entry = { record->timeNs, i };
+				heads.push (entry);
+			}
+		}
+
+		PPBPTraceWriter writer;
+		if (!writer.Open (output))
+		{
+			RemoveParts (output, sources);
+			NS_ABORT_MSG ("Cannot create " << output);
+		}
+		while (!heads.empty ())
+		{
+			MergeEntry entry = heads.top ();
+			heads.pop ();
+			const PPBPTraceRecord *record = readers[entry.source]->Next ();
+			writer.Write (record->timeNs, record->size, record->source);
+			record = readers[entry.source]->Peek ();
+			if (record)
+			{
+				MergeEntry next = { record->timeNs, entry.source };
+				heads.push (next);
+			}
+		}
+		uint64_t packets = writer.GetRecordCount ();
+		bool written = writer.Close (duration.GetNanoSeconds ());
+
+		for (uint32_t i = 0; i < sources; ++i)
+		{
+			delete readers[i];
+		}
+		RemoveParts (output, sources);
+		if (!written)
+		{
+			remove (output.c_str ());
+			NS_ABORT_MSG ("Cannot write " << output);
+		}
+		return packets;
+	}
+
+} // namespace ns3
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_trace_generator_h__
+#define __PPBP_trace_generator_h__
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "PPBP-trace.h"
+#include "PPBP-engine.h"
+#include "PPBP-variate-buffer.h"
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Run the PPBP process of PPBPApplication outside the simulator
+	 *        and write its packet departures to a PPBP trace.
+	 *
+	 * The generator takes the same attributes as PPBPApplication, draws its
+	 * random variates in the same order and paces packets with the same
+	 * formula, so with the same streams it produces the packet times that a
+	 * PPBPApplication started at t=0 would send. Nothing is scheduled in the
+	 * ns-3 Simulator; the process runs in the PPBPEngine of the application,
+	 * driven by its own loop.
+	 */
+	class PPBPTraceGenerator : public Object
+	{
+	public:
+		static TypeId GetTypeId (void);
+
+		PPBPTraceGenerator ();
+
+		virtual ~PPBPTraceGenerator();
+
+		/**
+		 * \brief Assign a fixed random variable stream number to the random variables
+		 * used by this model.
+		 *
+		 * \param stream first stream index to use
+		 * \return the number of stream indices assigned by this model
+		 */
+		int64_t       AssignStreams (int64_t stream);
+
+		/**
+		 * \brief Generate the packets sent in [0, duration).
+		 *
+		 * \param duration time span to generate
+		 * \param writer open trace writer receiving the packets
+		 * \param source index stored in every record
+		 * \return the number of packets generated
+		 */
+		uint64_t      Generate (Time duration, PPBPTraceWriter &writer, uint32_t source = 0);
+
+	protected:
+		virtual void DoDispose ();
+
+	private:
+		void SetHurst(double h);
+		double GetHurst() const;
+
+		Time DrawArrival(Time now);						// Draw the next burst arrival
+		Time DrawBurstLength();							// Draw the length of that burst
+		void StationaryStart();							// Add the bursts of the steady state
+
+		// Policies of m_engine
+		struct Arrivals
+		{
+			PPBPTraceGenerator *gen;
+			Arrivals (PPBPTraceGenerator *g = 0) : gen (g) {}
+			int64_t Next (int64_t now) { return gen->DrawArrival (TimeStep (now)).GetTimeStep (); }
+		};
+		struct Lengths
+		{
+			PPBPTraceGenerator *gen;
+			Lengths (PPBPTraceGenerator *g = 0) : gen (g) {}
+			int64_t Next () { return gen->DrawBurstLength ().GetTimeStep (); }
+		};
+		struct Sink
+		{
+			PPBPTraceWriter *writer;
+			uint32_t source;
+			uint32_t size;
+			uint64_t packets;
+			Sink () : writer (0), source (0), size (0), packets (0) {}
+			uint32_t BurstStart (int64_t now, int64_t length) { return 0; }
+			void BurstEnd (int64_t now, int64_t length, uint32_t tag) {}
+			void Send (int64_t now, const uint32_t *sizeClasses, uint32_t n)
+			{
+				for (uint32_t i = 0; i < n; ++i)
+				{
+					writer->Write (TimeStep (now).GetNanoSeconds (), size, source);
+				}
+				packets += n;
+			}
+		};
+
+		uint32_t		m_pktSize;						// Size of packets
+		uint32_t		m_headerOverhead;				// Bytes added to each packet when pacing
+		DataRate        m_cbrRate;						// Burst intensity (constant bit-rate)
+		Ptr<RandomVariableStream>	m_burstArrivals;	// Mean rate of burst arrivals
+		Ptr<RandomVariableStream>   m_burstLength;		// Mean burst time length
+		Time			m_maxBurstLength;				// Bound of the burst lengths, zero for none
+		double			m_boundedMean;					// Mean the bounded scale was solved for
+		double			m_boundedShape;					// Shape the bounded scale was solved for
+		double			m_boundedScale;					// Pareto scale of the bounded lengths
+		bool			m_stationaryStart;				// Start with the bursts of the steady state
+		double			m_mean;							// Last mean burst length drawn (s)
+		double			m_timeSlot;						// Last Pareto scale (s)
+		double			m_h;							// Hurst parameter	(Pareto distribution)
+		double			m_shape;						// Shape			(Pareto distribution)
+
+		Ptr<ExponentialRandomVariable>	m_arrivalVariate;	// Inter-burst intervals
+		Ptr<ParetoRandomVariable>		m_lengthVariate;	// Burst lengths
+
+		// State of the run in progress
+		PPBPEngine<Arrivals, Lengths, PPBPFixedSize, Sink>
+						m_engine;						// Bursts, pacer and packet departures
+	};
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Generate many independent PPBP sources on a pool of threads and
+	 *        merge them into one time-ordered trace.
+	 *
+	 * Source i uses its own PPBPTraceGenerator with streams
+	 * stream + 4 i .. stream + 4 i + 3, and is written to its own part file.
+	 * The part files are then merged with a k-way merge, ties being broken by
+	 * source index. The output therefore does not depend on the number of
+	 * threads.
+	 *
+	 * The generators are created on the calling thread; only Generate ()
+	 * runs on the workers. Give MeanBurstArrivals and MeanBurstTimeLength as
+	 * strings, so that every source gets its own random variable. Time::SetResolution () must have been called
+	 * beforehand, as in the example programs, so that Time no longer records
+	 * its instances globally.
+	 */
+	class PPBPParallelTraceGenerator
+	{
+	public:
+		PPBPParallelTraceGenerator ();
+
+		/**
+		 * Set an attribute of the underlying PPBPTraceGenerator objects.
+		 *
+		 * \param name the name of the generator attribute to set
+		 * \param value the value of the generator attribute to set
+		 */
+		void SetAttribute (std::string name, const AttributeValue &value);
+
+		/**
+		 * \brief Generate sources independent sources into one trace.
+		 *
+		 * \param sources number of sources
+		 * \param duration time span to generate
+		 * \param stream first stream index to use
+		 * \param threads number of worker threads (0 for one per core)
+		 * \param output trace file to write
+		 * \return the number of packets written
+		 *
+		 * Aborts if a part file or the output cannot be written, so that a
+		 * full disk never leaves a truncated trace behind a zero exit status.
+		 * The part files, and a partly written output, are removed first.
+		 */
+		uint64_t Generate (uint32_t sources, Time duration, int64_t stream,
+						   uint32_t threads, std::string output);
+
+	private:
+		static std::string GetPartName (std::string output, uint32_t source);
+		static void RemoveParts (std::string output, uint32_t sources);
+
+		ObjectFactory	m_factory;
+	};
+
+} // namespace ns3
+#endif
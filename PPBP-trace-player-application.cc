@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-trace-player-application.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/address.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+#include "ns3/packet.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/string.h"
+
+NS_LOG_COMPONENT_DEFINE ("PPBPTracePlayerApplication");
+
+namespace ns3 {
+
+	NS_OBJECT_ENSURE_REGISTERED (PPBPTracePlayerApplication);
+
+	TypeId
+	PPBPTracePlayerApplication::GetTypeId (void)
+	{
+		static TypeId tid = TypeId ("ns3::PPBPTracePlayerApplication")
+		.SetParent<Application> ()
+		.AddConstructor<PPBPTracePlayerApplication> ()
+		.AddAttribute ("TraceFile", "The PPBP trace file to replay",
+					   StringValue (""),
+					   MakeStringAccessor (&PPBPTracePlayerApplication::m_traceFile),
+					   MakeStringChecker ())
+		.AddAttribute ("Remote", "The address of the destination",
+					   AddressValue (),
+					   MakeAddressAccessor (&PPBPTracePlayerApplication::m_peer),
+					   MakeAddressChecker ())
+		.AddAttribute ("Protocol", "The type of protocol to use.",
+					   TypeIdValue (UdpSocketFactory::GetTypeId ()),
+					   MakeTypeIdAccessor (&PPBPTracePlayerApplication::m_protocolTid),
+					   MakeTypeIdChecker ())
+		.AddTraceSource ("Tx", "A new packet is created and is sent",
+						 MakeTraceSourceAccessor (&PPBPTracePlayerApplication::m_txTrace),
+						 "ns3::Packet::TracedCallback")
+		;
+		return tid;
+	}
+
+	PPBPTracePlayerApplication::PPBPTracePlayerApplication ()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		m_socket = 0;
+		m_totalBytes = 0;
+	}
+
+	PPBPTracePlayerApplication::~PPBPTracePlayerApplication()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+	}
+
+	uint64_t
+	PPBPTracePlayerApplication::GetTotalBytes() const
+	{
+		return m_totalBytes;
+	}
+
+	void
+	PPBPTracePlayerApplication::DoDispose (void)
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+
+		m_socket = 0;
+		m_reader.Close ();
+		// chain up
+		Application::DoDispose ();
+	}
+
+	void
+	PPBPTracePlayerApplication::StartApplication() // Called at time specified by Start
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+
+		if (!m_reader.Open (m_traceFile))
+		{
+			NS_FATAL_ERROR ("PPBPTracePlayerApplication cannot replay " << m_traceFile);
+		}
+
+		// Create the socket if not already
+		if (!m_socket)
+		{
+			m_socket = Socket::CreateSocket (GetNode(), m_protocolTid);
+			m_socket->Bind ();
+			m_socket->Connect (m_peer);
+		}
+		m_startTime = Simulator::Now ();
+		ScheduleNextTx ();
+	}
+
+	void
+	PPBPTracePlayerApplication::StopApplication() // Called at time specified by Stop
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+
+		Simulator::Cancel (m_sendEvent);
+		m_reader.Close ();
+		if(m_socket != 0) m_socket->Close ();
+		else NS_LOG_WARN("PPBPTracePlayerApplication found null socket to close in StopApplication");
+	}
+
+	void
+	PPBPTracePlayerApplication::ScheduleNextTx()
+	{
+		const PPBPTraceRecord *record = m_reader.Peek ();
+		if (record == 0)
+		{
+			NS_LOG_LOGIC ("End of trace " << m_traceFile);
+			return;
+		}
+		Time next = m_startTime + NanoSeconds (record->timeNs);
+		m_sendEvent = Simulator::Schedule (next - Simulator::Now (), &PPBPTracePlayerApplication::SendPackets, this);
+	}
+
+	void
+	PPBPTracePlayerApplication::SendPackets()
+	{
+		NS_LOG_FUNCTION_NOARGS ();
+		// Send every record due now, then wait for the next one
+		uint64_t now = (Simulator::Now () - m_startTime).GetNanoSeconds ();
+		const PPBPTraceRecord *record;
+		while ((record = m_reader.Peek ()) != 0 && record->timeNs <= now)
+		{
+			Ptr<Packet> packet = Create<Packet> (record->size);
+			m_txTrace (packet);
+			m_socket->Send (packet);
+			m_totalBytes += packet->GetSize ();
+			m_reader.Next ();
+		}
+		ScheduleNextTx ();
+	}
+
+} // namespace ns3
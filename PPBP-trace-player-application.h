@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_trace_player_application_h__
+#define __PPBP_trace_player_application_h__
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+#include "PPBP-trace.h"
+#include <string>
+
+namespace ns3 {
+
+	class Socket;
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Replay a PPBP trace file to a single destination.
+	 *
+	 * The trace, written by PPBPTraceGenerator, is memory-mapped and walked
+	 * with a single cursor. Packet times are relative to the application
+	 * start time. Only one send event is pending at any time.
+	 */
+	class PPBPTracePlayerApplication : public Application
+	{
+	public:
+		static TypeId GetTypeId (void);
+
+		PPBPTracePlayerApplication ();
+
+		virtual ~PPBPTracePlayerApplication();
+
+		/**
+		 * \brief Return total bytes sent by this object.
+		 */
+		uint64_t      GetTotalBytes() const;
+
+	protected:
+		virtual void DoDispose ();
+
+	private:
+		// Inherited from Application base class.
+		virtual void StartApplication ();				// Called at time specified by Start
+		virtual void StopApplication ();				// Called at time specified by Stop
+
+		void ScheduleNextTx();
+		void SendPackets();
+
+		Ptr<Socket>     m_socket;						// Associated socket
+		TypeId          m_protocolTid;					// protocol type id
+		Address         m_peer;							// Peer address
+		std::string		m_traceFile;					// Trace to replay
+
+		PPBPTraceReader	m_reader;						// Cursor over the mapped trace
+		Time			m_startTime;					// Time the replay started
+		EventId         m_sendEvent;					// Event id of pending "send packet" event
+		uint64_t        m_totalBytes;					// Total bytes sent so far
+
+		TracedCallback< Ptr<const Packet> > m_txTrace;	// Trace callback for each sent packet
+	};
+
+} // namespace ns3
+#endif
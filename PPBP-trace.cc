@@ -0,0 +1,289 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-trace.h"
+#include "ns3/log.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPTrace");
+
+namespace ns3 {
+
+	static_assert (sizeof (PPBPTraceHeader) == 64, "PPBP trace header must be 64 bytes");
+	static_assert (sizeof (PPBPTraceRecord) == 16, "PPBP trace record must be 16 bytes");
+
+	static const char g_magic[8] = { 'P', 'P', 'B', 'P', 'T', 'R', 'C', 0 };
+	static const size_t g_writeBatch = 64 * 1024;					// Records per write
+	static const size_t g_releaseChunk = 64 * 1024 * 1024;			// Bytes consumed before release
+
+	PPBPTraceWriter::PPBPTraceWriter ()
+		: m_file (0),
+		  m_count (0),
+		  m_error (false)
+	{
+	}
+
+	PPBPTraceWriter::~PPBPTraceWriter ()
+	{
+		if (m_file)
+		{
+			NS_LOG_WARN ("PPBPTraceWriter destroyed without Close (); header not finalized");
+			Flush ();
+			fclose (m_file);
+		}
+	}
+
+	bool
+	PPBPTraceWriter::Open (const std::string &filename)
+	{
+		NS_LOG_FUNCTION (this << filename);
+		m_file = fopen (filename.c_str (), "wb");
+		if (!m_file)
+		{
+			NS_LOG_ERROR ("Cannot create trace file " << filename);
+			return false;
+		}
+		m_count = 0;
+		m_error = false;
+		m_buffer.clear ();
+		m_buffer.reserve (g_writeBatch);
+
+		// Placeholder, rewritten by Close ()
+		PPBPTraceHeader header;
+		memset (&header, 0, sizeof (header));
+		if (fwrite (&header, sizeof (header), 1, m_file) != 1)
+		{
+			NS_LOG_ERROR ("Cannot write trace file " << filename);
+			m_error = true;
+		}
+		return true;
+	}
+
+	void
+	PPBPTraceWriter::Write (uint64_t timeNs, uint32_t size, uint32_t source)
+	{
+		PPBPTraceRecord record;
+		record.timeNs = timeNs;
+		record.size = size;
+		record.source = source;
+		m_buffer.push_back (record);
+		if (m_buffer.size () == g_writeBatch)
+		{
+			Flush ();
+		}
+	}
+
+	bool
+	PPBPTraceWriter::Flush ()
+	{
+		if (!m_buffer.empty () && !m_error)
+		{
+			if (fwrite (&m_buffer[0], sizeof (PPBPTraceRecord), m_buffer.size (), m_file) != m_buffer.size ())
+			{
+				NS_LOG_ERROR ("Cannot write " << m_buffer.size () << " trace records");
+				m_error = true;
+			}
+			m_count += m_buffer.size ();
+		}
+		m_buffer.clear ();
+		return !m_error;
+	}
+
+	bool
+	PPBPTraceWriter::Close (uint64_t durationNs)
+	{
+		NS_LOG_FUNCTION (this << durationNs);
+		if (!m_file)
+		{
+			return !m_error;
+		}
+		if (!Flush ())
+		{
+			// Keep the placeholder header so the truncated trace is rejected
+			fclose (m_file);
+			m_file = 0;
+			return false;
+		}
+
+		PPBPTraceHeader header;
+		memset (&header, 0, sizeof (header));
+		memcpy (header.magic, g_magic, sizeof (g_magic));
+		header.version = PPBP_TRACE_VERSION;
+		header.headerSize = sizeof (PPBPTraceHeader);
+		header.recordSize = sizeof (PPBPTraceRecord);
+		header.byteOrder = PPBP_TRACE_BYTE_ORDER;
+		header.recordCount = m_count;
+		header.durationNs = durationNs;
+		if (fseek (m_file, 0, SEEK_SET) != 0 || fwrite (&header, sizeof (header), 1, m_file) != 1)
+		{
+			NS_LOG_ERROR ("Cannot write the trace header");
+			m_error = true;
+		}
+		if (fclose (m_file) != 0)
+		{
+			NS_LOG_ERROR ("Cannot close the trace file");
+			m_error = true;
+		}
+		m_file = 0;
+		return !m_error;
+	}
+
+	uint64_t
+	PPBPTraceWriter::GetRecordCount () const
+	{
+		return m_count + m_buffer.size ();
+	}
+
+	bool
+	PPBPTraceWriter::IsOk () const
+	{
+		return !m_error;
+	}
+
+	PPBPTraceReader::PPBPTraceReader ()
+		: m_base (0),
+		  m_length (0),
+		  m_cursor (0),
+		  m_end (0),
+		  m_released (0)
+	{
+		memset (&m_header, 0, sizeof (m_header));
+	}
+
+	PPBPTraceReader::~PPBPTraceReader ()
+	{
+		Close ();
+	}
+
+	bool
+	PPBPTraceReader::Open (const std::string &filename)
+	{
+		NS_LOG_FUNCTION (this << filename);
+		Close ();
+
+		int fd = open (filename.c_str (), O_RDONLY);
+		if (fd < 0)
+		{
+			NS_LOG_ERROR ("Cannot open trace file " << filename);
+			return false;
+		}
+		struct stat st;
+		if (fstat (fd, &st) != 0 || (size_t) st.st_size < sizeof (PPBPTraceHeader))
+		{
+			NS_LOG_ERROR ("Trace file " << filename << " is too short");
+			close (fd);
+			return false;
+		}
+		m_length = st.st_size;
+		void *base = mmap (0, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+		close (fd);
+		if (base == MAP_FAILED)
+		{
+			NS_LOG_ERROR ("Cannot map trace file " << filename);
+			m_length = 0;
+			return false;
+		}
+		m_base = static_cast<uint8_t *> (base);
+		madvise (m_base, m_length, MADV_SEQUENTIAL);
+
+		memcpy (&m_header, m_base, sizeof (m_header));
+		if (memcmp (m_header.magic, g_magic, sizeof (g_magic)) == 0
+			&& m_header.byteOrder != PPBP_TRACE_BYTE_ORDER && m_header.byteOrder != 0)
+		{
+			NS_LOG_ERROR ("Trace " << filename << " was written on a host of another byte order");
+			Close ();
+			return false;
+		}
+		if (memcmp (m_header.magic, g_magic, sizeof (g_magic)) != 0
+			|| m_header.version != PPBP_TRACE_VERSION
+			|| m_header.byteOrder != PPBP_TRACE_BYTE_ORDER
+			|| m_header.headerSize != sizeof (PPBPTraceHeader)
+			|| m_header.recordSize != sizeof (PPBPTraceRecord)
+			|| m_header.recordCount > (m_length - sizeof (PPBPTraceHeader)) / sizeof (PPBPTraceRecord))
+		{
+			NS_LOG_ERROR ("File " << filename << " is not a version " << PPBP_TRACE_VERSION << " PPBP trace");
+			Close ();
+			return false;
+		}
+
+		m_cursor = reinterpret_cast<const PPBPTraceRecord *> (m_base + sizeof (PPBPTraceHeader));
+		m_end = m_cursor + m_header.recordCount;
+		m_released = m_base;
+		return true;
+	}
+
+	void
+	PPBPTraceReader::Close ()
+	{
+		if (m_base)
+		{
+			munmap (m_base, m_length);
+		}
+		m_base = 0;
+		m_length = 0;
+		m_cursor = 0;
+		m_end = 0;
+		m_released = 0;
+	}
+
+	const PPBPTraceHeader &
+	PPBPTraceReader::GetHeader () const
+	{
+		return m_header;
+	}
+
+	const PPBPTraceRecord *
+	PPBPTraceReader::Peek () const
+	{
+		return m_cursor < m_end ? m_cursor : 0;
+	}
+
+	const PPBPTraceRecord *
+	PPBPTraceReader::Next ()
+	{
+		if (m_cursor >= m_end)
+		{
+			return 0;
+		}
+		const PPBPTraceRecord *record = m_cursor++;
+		if (reinterpret_cast<const uint8_t *> (m_cursor) - m_released >= (ptrdiff_t) g_releaseChunk)
+		{
+			Release ();
+		}
+		return record;
+	}
+
+	void
+	PPBPTraceReader::Release ()
+	{
+		// Drop whole pages behind the cursor; they are re-read from the
+		// file if ever touched again.
+		size_t page = sysconf (_SC_PAGESIZE);
+		size_t consumed = reinterpret_cast<const uint8_t *> (m_cursor) - m_base;
+		const uint8_t *upTo = m_base + consumed / page * page;
+		if (upTo > m_released)
+		{
+			madvise (const_cast<uint8_t *> (m_released), upTo - m_released, MADV_DONTNEED);
+			m_released = upTo;
+		}
+	}
+
+} // namespace ns3
@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_trace_h__
+#define __PPBP_trace_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * On-disk layout of a PPBP packet trace (version 2).
+	 *
+	 * A trace is a fixed 64-byte header followed by recordCount fixed-size
+	 * records sorted by time. All fields are in the byte order of the host
+	 * that wrote the trace; byteOrder holds PPBP_TRACE_BYTE_ORDER in that
+	 * order, and readers on a host of the other byte order reject the
+	 * trace. Records are 16 bytes so that a memory-mapped trace can be
+	 * walked with a plain pointer, without any per-packet parsing.
+	 */
+	struct PPBPTraceHeader
+	{
+		char		magic[8];						// "PPBPTRC" followed by a NUL
+		uint32_t	version;						// Format version (PPBP_TRACE_VERSION)
+		uint32_t	headerSize;						// sizeof (PPBPTraceHeader)
+		uint32_t	recordSize;						// sizeof (PPBPTraceRecord)
+		uint32_t	flags;							// Reserved, 0
+		uint64_t	recordCount;					// Number of records following the header
+		uint64_t	durationNs;						// Generated time span
+		uint32_t	byteOrder;						// PPBP_TRACE_BYTE_ORDER in host order
+		uint8_t		reserved[20];
+	};
+
+	struct PPBPTraceRecord
+	{
+		uint64_t	timeNs;							// Packet departure time
+		uint32_t	size;							// Packet size (bytes)
+		uint32_t	source;							// Index of the generating source
+	};
+
+	static const uint32_t PPBP_TRACE_VERSION = 2;
+	static const uint32_t PPBP_TRACE_BYTE_ORDER = 0x01020304;
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Write a PPBP packet trace through a large user-space buffer.
+	 *
+	 * The header is rewritten with the final record count by Close ().
+	 * The first failed write is latched: later records are dropped and
+	 * Close () leaves the zeroed placeholder header, which no reader
+	 * accepts, instead of finalizing a truncated trace.
+	 */
+	class PPBPTraceWriter
+	{
+	public:
+		PPBPTraceWriter ();
+		~PPBPTraceWriter ();
+
+		/**
+		 * \brief Create (or truncate) the trace file.
+		 * \return false if the file could not be created.
+		 */
+		bool Open (const std::string &filename);
+
+		void Write (uint64_t timeNs, uint32_t size, uint32_t source);
+
+		/**
+		 * \brief Flush the buffer and write the final header.
+		 * \param durationNs the time span covered by the trace.
+		 * \return false if any write to the file failed.
+		 */
+		bool Close (uint64_t durationNs);
+
+		uint64_t GetRecordCount () const;
+
+		/**
+		 * \return false once a write to the file has failed.
+		 */
+		bool IsOk () const;
+
+	private:
+		PPBPTraceWriter (const PPBPTraceWriter &);
+		PPBPTraceWriter &operator= (const PPBPTraceWriter &);
+
+		bool Flush ();
+
+		FILE							*m_file;
+		std::vector<PPBPTraceRecord>	m_buffer;
+		uint64_t						m_count;
+		bool							m_error;		// A write has failed
+	};
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Streaming cursor over a memory-mapped PPBP packet trace.
+	 *
+	 * The file is mapped read-only and walked front to back; its descriptor
+	 * is closed once mapped, so many readers can be open at once. Pages already
+	 * consumed are released every few megabytes, so the resident size stays
+	 * bounded whatever the trace size.
+	 */
+	class PPBPTraceReader
+	{
+	public:
+		PPBPTraceReader ();
+		~PPBPTraceReader ();
+
+		/**
+		 * \brief Map the trace file and check its header.
+		 * \return false if the file is missing or is not a valid trace.
+		 */
+		bool Open (const std::string &filename);
+		void Close ();
+
+		const PPBPTraceHeader &GetHeader () const;
+
+		/**
+		 * \return the record under the cursor, or 0 at the end of the trace.
+		 */
+		const PPBPTraceRecord *Peek () const;
+
+		/**
+		 * \return the record under the cursor and advance, or 0 at the end.
+		 */
+		const PPBPTraceRecord *Next ();
+
+	private:
+		PPBPTraceReader (const PPBPTraceReader &);
+		PPBPTraceReader &operator= (const PPBPTraceReader &);
+
+		void Release ();
+
+		uint8_t					*m_base;			// Start of the mapping
+		size_t					m_length;			// Length of the mapping
+		PPBPTraceHeader			m_header;
+		const PPBPTraceRecord	*m_cursor;
+		const PPBPTraceRecord	*m_end;
+		const uint8_t			*m_released;		// Mapping released up to here
+	};
+
+} // namespace ns3
+#endif
@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PPBP-variate-buffer.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("PPBPVariateBuffer");
+
+namespace ns3 {
+
+	PPBPVariateBuffer::PPBPVariateBuffer ()
+		: m_blockSize (1024),
+		  m_shape (1.6),
+		  m_expNext (0),
+		  m_paretoNext (0),
+		  m_expDrawn (0),
+		  m_paretoDrawn (0)
+	{
+		m_expUniform = CreateObject<UniformRandomVariable> ();
+		m_paretoUniform = CreateObject<UniformRandomVariable> ();
+	}
+
+	void
+	PPBPVariateBuffer::SetBlockSize (uint32_t size)
+	{
+		NS_LOG_FUNCTION (this << size);
+		m_blockSize = size;
+		m_exp.clear ();
+		m_paretoU.clear ();
+		m_pareto.clear ();
+		m_expNext = 0;
+		m_paretoNext = 0;
+	}
+
+	uint32_t
+	PPBPVariateBuffer::GetBlockSize () const
+	{
+		return m_blockSize;
+	}
+
+	void
+	PPBPVariateBuffer::SetShape (double shape)
+	{
+		NS_LOG_FUNCTION (this << shape);
+		if (shape != m_shape)
+		{
+			m_shape = shape;
+			TransformPareto (m_paretoNext);
+		}
+	}
+
+	int64_t
+	PPBPVariateBuffer::AssignStreams (int64_t stream)
+	{
+		NS_LOG_FUNCTION (this << stream);
+		m_expUniform->SetStream (stream);
+		m_paretoUniform->SetStream (stream + 1);
+		SetBlockSize (m_blockSize);
+		return 2;
+	}
+
+	void
+	PPBPVariateBuffer::GetState (uint64_t &expDrawn, uint32_t &expNext, uint64_t &paretoDrawn, uint32_t &paretoNext) const
+	{
+		expDrawn = m_expDrawn;
+		expNext = m_expNext;
+		paretoDrawn = m_paretoDrawn;
+		paretoNext = m_paretoNext;
+	}
+
+	void
+	PPBPVariateBuffer::SetState (uint64_t expDrawn, uint32_t expNext, uint64_t paretoDrawn, uint32_t paretoNext)
+	{
+		NS_LOG_FUNCTION (this << expDrawn << expNext << paretoDrawn << paretoNext);
+		// Skip to the start of the current block, then draw it again
+		if (expDrawn >= m_blockSize && m_blockSize > 0)
+		{
+			for (uint64_t i = m_expDrawn; i < expDrawn - m_blockSize; ++i)
+			{
+				m_expUniform->GetValue ();
+			}
+			m_expDrawn = expDrawn - m_blockSize;
+			FillExponential ();
+			m_expNext = expNext;
+		}
+		if (paretoDrawn >= m_blockSize && m_blockSize > 0)
+		{
+			for (uint64_t i = m_paretoDrawn; i < paretoDrawn - m_blockSize; ++i)
+			{
+				m_paretoUniform->GetValue ();
+			}
+			m_paretoDrawn = paretoDrawn - m_blockSize;
+			FillPareto ();
+			m_paretoNext = paretoNext;
+		}
+	}
+
+	double
+	PPBPVariateBuffer::GetBoundedParetoMean (double scale, double shape, double bound)
+	{
+		if (bound <= 0)
+		{
+			return shape * scale / (shape - 1);
+		}
+		double r = scale / bound;
+		if (std::fabs (shape - 1) < 1e-9)
+		{
+			return scale * std::log (1 / r) / (1 - r);
+		}
+		return shape * scale * (1 - std::pow (r, shape - 1)) / ((shape - 1) * (1 - std::pow (r, shape)));
+	}
+
+	double
+	PPBPVariateBuffer::GetBoundedParetoScale (double mean, double shape, double bound)
+	{
+		if (bound <= 0)
+		{
+			return (shape - 1) * mean / shape;
+		}
+		// The mean grows with the scale and is above it, so the scale lies
+		// in (0, mean)
+		double lo = 0;
+		double hi = std::min (mean, bound);
+		for (uint32_t i = 0; i < 100 && hi - lo > 1e-12 * hi; ++i)
+		{
+			double mid = (lo + hi) / 2;
+			if (GetBoundedParetoMean (mid, shape, bound) < mean)
+			{
+				lo = mid;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+		return (lo + hi) / 2;
+	}
+
+	double
+	PPBPVariateBuffer::GetResidualPareto (double scale, double shape, double bound, double u1, double u2)
+	{
+		// A length-biased draw is a Pareto of shape - 1 with the same scale and
+		// bound, and the residual is a uniform fraction of it
+		double b = shape - 1;
+		double x;
+		if (bound <= 0)
+		{
+			x = scale * std::pow (u1, -1 / b);
+		}
+		else if (std::fabs (b) < 1e-9)
+		{
+			x = scale * std::pow (bound / scale, u1);
+		}
+		else
+		{
+			x = scale * std::pow (1 - u1 * (1 - std::pow (scale / bound, b)), -1 / b);
+		}
+		return u2 * x;
+	}
+
+	void
+	PPBPVariateBuffer::FillExponential ()
+	{
+		m_exp.resize (m_blockSize);
+		for (uint32_t i = 0; i < m_blockSize; ++i)
+		{
+			m_exp[i] = m_expUniform->GetValue ();
+		}
+		m_expDrawn += m_blockSize;
+		double *e = &m_exp[0];
+		for (uint32_t i = 0; i < m_blockSize; ++i)
+		{
+			e[i] = -std::log (e[i]);
+		}
+		m_expNext = 0;
+	}
+
+	void
+	PPBPVariateBuffer::FillPareto ()
+	{
+		m_paretoU.resize (m_blockSize);
+		m_pareto.resize (m_blockSize);
+		for (uint32_t i = 0; i < m_blockSize; ++i)
+		{
+			m_paretoU[i] = m_paretoUniform->GetValue ();
+		}
+		m_paretoDrawn += m_blockSize;
+		TransformPareto (0);
+		m_paretoNext = 0;
+	}
+
+	void
+	PPBPVariateBuffer::TransformPareto (uint32_t from)
+	{
+		// u^(-1/shape) = exp (-log (u) / shape)
+		double invShape = 1.0 / m_shape;
+		const double *u = m_paretoU.empty () ? 0 : &m_paretoU[0];
+		double *p = m_pareto.empty () ? 0 : &m_pareto[0];
+		uint32_t n = m_pareto.size ();
+		for (uint32_t i = from; i < n; ++i)
+		{
+			p[i] = std::exp (-std::log (u[i]) * invShape);
+		}
+	}
+
+} // namespace ns3
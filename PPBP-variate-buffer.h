@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PPBP_variate_buffer_h__
+#define __PPBP_variate_buffer_h__
+
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+	/**
+	 * \ingroup PPBP
+	 *
+	 * \brief Block-sampled exponential and Pareto variates for the PPBP.
+	 *
+	 * A block of uniforms is drawn from the stream, still one GetValue ()
+	 * call per uniform since ns-3 random streams have no bulk draw, and is
+	 * then turned into unit-mean exponentials (-log u) and unit-scale
+	 * Paretos (u^(-1/shape)) by branch-free loops over the whole block,
+	 * which the compiler can vectorize. Only this log/pow transform is
+	 * batched; the getters then scale a buffered value. These are
+	 * the inverse transforms used by ExponentialRandomVariable and
+	 * ParetoRandomVariable, so on the same uniform stream the values match
+	 * those of the per-call path up to floating-point rounding.
+	 *
+	 * The raw Pareto uniforms are kept, so a change of shape re-transforms
+	 * the rest of the block instead of discarding it.
+	 */
+	class PPBPVariateBuffer
+	{
+	public:
+		PPBPVariateBuffer ();
+
+		/**
+		 * \brief Set the number of variates drawn per block, and drop the
+		 * buffered ones.
+		 */
+		void SetBlockSize (uint32_t size);
+		uint32_t GetBlockSize () const;
+
+		/**
+		 * \brief Set the Pareto shape.
+		 */
+		void SetShape (double shape);
+
+		/**
+		 * \brief Assign a fixed random variable stream number to the uniforms
+		 * of the exponential and Pareto blocks.
+		 *
+		 * \param stream first stream index to use
+		 * \return the number of stream indices assigned (2)
+		 */
+		int64_t AssignStreams (int64_t stream);
+
+		/**
+		 * \brief Get the position in the uniform streams: uniforms drawn so
+		 * far and index of the next variate of the current block.
+		 */
+		void GetState (uint64_t &expDrawn, uint32_t &expNext, uint64_t &paretoDrawn, uint32_t &paretoNext) const;
+
+		/**
+		 * \brief Move freshly assigned streams to a position saved with
+		 * GetState, with the same block size and shape.
+		 */
+		void SetState (uint64_t expDrawn, uint32_t expNext, uint64_t paretoDrawn, uint32_t paretoNext);
+
+		/**
+		 * \return an exponential variate of the given mean.
+		 */
+		double GetExponential (double mean)
+		{
+			if (m_expNext == m_exp.size ())
+			{
+				FillExponential ();
+			}
+			return mean * m_exp[m_expNext++];
+		}
+
+		/**
+		 * \return a Pareto variate of the given scale and the current shape.
+		 */
+		double GetPareto (double scale)
+		{
+			if (m_paretoNext == m_pareto.size ())
+			{
+				FillPareto ();
+			}
+			return scale * m_pareto[m_paretoNext++];
+		}
+
+		/**
+		 * \return a Pareto variate of the given scale and the current shape,
+		 * redrawn until it is not above bound (no bound if 0). This is the
+		 * rejection used by ParetoRandomVariable.
+		 */
+		double GetPareto (double scale, double bound)
+		{
+			double v = GetPareto (scale);
+			while (bound > 0 && v > bound)
+			{
+				v = GetPareto (scale);
+			}
+			return v;
+		}
+
+		/**
+		 * \return the mean of a Pareto of the given scale and shape bounded
+		 * to [scale, bound], or unbounded if bound is 0.
+		 */
+		static double GetBoundedParetoMean (double scale, double shape, double bound);
+
+		/**
+		 * \return the scale of the Pareto of the given shape, bounded to
+		 * [scale, bound], whose mean is the given mean. The mean must be
+		 * below the bound.
+		 */
+		static double GetBoundedParetoScale (double mean, double shape, double bound);
+
+		/**
+		 * \return a draw from the equilibrium (residual life) distribution of
+		 * the Pareto of the given scale and shape, bounded to [scale, bound] or
+		 * unbounded if bound is 0, given two uniforms in (0, 1].
+		 */
+		static double GetResidualPareto (double scale, double shape, double bound, double u1, double u2);
+
+	private:
+		void FillExponential ();
+		void FillPareto ();
+		void TransformPareto (uint32_t from);
+
+		uint32_t						m_blockSize;
+		double							m_shape;
+		Ptr<UniformRandomVariable>		m_expUniform;
+		Ptr<UniformRandomVariable>		m_paretoUniform;
+		std::vector<double>				m_exp;				// Unit-mean exponentials
+		std::vector<double>				m_paretoU;			// Raw uniforms of m_pareto
+		std::vector<double>				m_pareto;			// Unit-scale Paretos
+		uint32_t						m_expNext;
+		uint32_t						m_paretoNext;
+		uint64_t						m_expDrawn;			// Uniforms drawn for m_exp so far
+		uint64_t						m_paretoDrawn;		// Uniforms drawn for m_pareto so far
+	};
+
+} // namespace ns3
+#endif
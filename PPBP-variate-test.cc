@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* This script checks the block-sampled variates of PPBPVariateBuffer
+*  against the per-call ExponentialRandomVariable and ParetoRandomVariable
+*  used when VariateBlockSize is 0. For both paths it draws the given number
+*  of values and checks, within the given number of standard errors:
+*  - the mean and variance of unit-mean exponentials;
+*  - the mean and variance of unit-scale Paretos of shape 4.5 (finite
+*    fourth moment, so the sample variance converges);
+*  - the Hill estimate of the tail index of Paretos of the given shape,
+*    over the largest 1% of the values;
+*  and that the two paths agree with each other. It also prints the time
+*  per draw of each path. It fails if any check is out of tolerance.
+*  Example run: Copy to scratch folder and run
+*  ./waf --run "scratch/PPBP-variate-test --draws=1000000 --blockSize=1024"
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "PPBP-check.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PPBPVariateTest");
+
+struct Moments
+{
+  double mean;
+  double variance;
+};
+
+static Moments
+GetMoments (const std::vector<double> &x)
+{
+  double mean = 0;
+  for (uint32_t i = 0; i < x.size (); ++i)
+    {
+      mean += x[i];
+    }
+  mean /= x.size ();
+  double m2 = 0;
+  for (uint32_t i = 0; i < x.size (); ++i)
+    {
+      m2 += (x[i] - mean) * (x[i] - mean);
+    }
+  Moments m = { mean, m2 / (x.size () - 1) };
+  return m;
+}
+
+// Hill estimate of the tail index over the k largest values
+static double
+GetHill (std::vector<double> x, uint32_t k)
+{
+  std::nth_element (x.begin (), x.begin () + k, x.end (), std::greater<double> ());
+  double threshold = x[k];
+  double sum = 0;
+  for (uint32_t i = 0; i < k; ++i)
+    {
+      sum += std::log (x[i] / threshold);
+    }
+  return k / sum;
+}
+
+static double
+Draw (std::vector<double> &x, std::function<double ()> draw)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < x.size (); ++i)
+    {
+      x[i] = draw ();
+    }
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count () * 1e9 / x.size ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t draws = 1000000;
+  uint32_t blockSize = 1024;
+  double shape = 1.6;
+  double sigmas = 5;
+
+  CommandLine cmd;
+  cmd.AddValue ("draws", "Values drawn per distribution and path", draws);
+  cmd.AddValue ("blockSize", "VariateBlockSize of the block path", blockSize);
+  cmd.AddValue ("shape", "Pareto shape of the tail-index check (3 - 2H)", shape);
+  cmd.AddValue ("sigmas", "Tolerance in standard errors", sigmas);
+  cmd.Parse (argc, argv);
+
+  double n = draws;
+  uint32_t k = draws / 100;
+  const double light = 4.5;
+  double lightMean = light / (light - 1);
+  double lightVariance = light / ((light - 1) * (light - 1) * (light - 2));
+  // Fourth central moment of the light Pareto, for the error of its variance
+  double lightM4 = 3 * light * (3 * light * light + light + 2)
+                   / ((light - 1) * (light - 1) * (light - 1) * (light - 1) * (light - 2) * (light - 3) * (light - 4));
+
+  Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable> ();
+  Ptr<ParetoRandomVariable> pareto = CreateObject<ParetoRandomVariable> ();
+  exponential->SetStream (0);
+  pareto->SetStream (1);
+  PPBPVariateBuffer buffer;
+  buffer.SetBlockSize (blockSize);
+  buffer.AssignStreams (2);
+
+  std::vector<double> x (draws);
+  std::vector<Moments> expMoments, lightMoments;
+  std::vector<double> hill;
+  for (uint32_t path = 0; path < 2; ++path)
+    {
+      bool block = path == 1;
+      NS_LOG_UNCOND ((block ? "Block path" : "Per-call path"));
+      double ns;
+
+      if (block)
+        {
+          ns = Draw (x, [&] () { return buffer.GetExponential (1); });
+        }
+      else
+        {
+          ns = Draw (x, [&] () { return exponential->GetValue (1, 0); });
+        }
+      Moments m = GetMoments (x);
+      PPBPCheck ("exponential mean", m.mean, 1, sigmas * std::sqrt (1 / n));
+      PPBPCheck ("exponential variance", m.variance, 1, sigmas * std::sqrt (8 / n));
+      NS_LOG_UNCOND ("  " << ns << " ns per exponential");
+      expMoments.push_back (m);
+
+      buffer.SetShape (light);
+      if (block)
+        {
+          ns = Draw (x, [&] () { return buffer.GetPareto (1); });
+        }
+      else
+        {
+          ns = Draw (x, [&] () { return pareto->GetValue (1, light, 0); });
+        }
+      m = GetMoments (x);
+      PPBPCheck ("Pareto mean", m.mean, lightMean, sigmas * std::sqrt (lightVariance / n));
+      PPBPCheck ("Pareto variance", m.variance, lightVariance,
+                 sigmas * std::sqrt ((lightM4 - lightVariance * lightVariance) / n));
+      NS_LOG_UNCOND ("  " << ns << " ns per Pareto");
+      lightMoments.push_back (m);
+
+      buffer.SetShape (shape);
+      if (block)
+        {
+          Draw (x, [&] () { return buffer.GetPareto (1); });
+        }
+      else
+        {
+          Draw (x, [&] () { return pareto->GetValue (1, shape, 0); });
+        }
+      hill.push_back (GetHill (x, k));
+      PPBPCheck ("Pareto tail index (Hill)", hill.back (), shape, sigmas * shape / std::sqrt ((double) k));
+    }
+
+  // Independent samples: the error of a difference is sqrt(2) times larger
+  NS_LOG_UNCOND ("Block against per-call path");
+  double s2 = std::sqrt (2.0);
+  PPBPCheck ("exponential mean", expMoments[1].mean - expMoments[0].mean, 0, s2 * sigmas * std::sqrt (1 / n));
+  PPBPCheck ("Pareto mean", lightMoments[1].mean - lightMoments[0].mean, 0, s2 * sigmas * std::sqrt (lightVariance / n));
+  PPBPCheck ("Pareto tail index (Hill)", hill[1] - hill[0], 0, s2 * sigmas * shape / std::sqrt ((double) k));
+
+  return PPBPCheckSummary ();
+}